@@ -0,0 +1,537 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include "Benchmark.h"
+#include "../oscpack/ip/UdpSocket.h"
+#include "../oscpack/osc/OscOutboundPacketStream.h"
+#include <cmath>
+#include <string>
+#include <stdexcept>
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define GENERATOR_BUFFER_SIZE 4096 //bytes, the largest packet a generator builds: the UDP inputs receive into 4098 byte buffers
+#define MAX_BUNDLE 256 //messages per packet
+#define MAX_ARGUMENTS 64 //per message
+#define PHASE_STEP 0.002 //of the continuous sweeps, per message
+#define DRAIN_TIMEOUT 2000 //ms to wait for the last packets to be received
+
+#if JUCE_WINDOWS
+static double fileTimeToSeconds(const FILETIME& Time)
+{
+	return (((int64)Time.dwHighDateTime << 32) | Time.dwLowDateTime) / 10000000.0;
+}
+#endif
+
+//User and system CPU time of the whole process
+static double getProcessCpuSeconds()
+{
+#if JUCE_WINDOWS
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	return fileTimeToSeconds(kernel) + fileTimeToSeconds(user);
+#else
+	timespec t;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t) != 0)
+		return 0;
+
+	return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+
+//User and system CPU time of the calling thread
+static double getThreadCpuSeconds()
+{
+#if JUCE_WINDOWS
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	return fileTimeToSeconds(kernel) + fileTimeToSeconds(user);
+#else
+	timespec t;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t) != 0)
+		return 0;
+
+	return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+
+static const char* getShapeName(int Shape)
+{
+	return Shape==SHAPE_RANDOM ? "random" : (Shape==SHAPE_OUTSIDE ? "outside" : "continuous");
+}
+
+BenchmarkSettings::BenchmarkSettings()
+{
+	seconds = 10;
+	warmup = 1;
+	threads = 1;
+	rate = 0;
+	bundle = 1;
+	arguments = 0;
+	shape = SHAPE_CONTINUOUS;
+}
+
+void BenchmarkSettings::parse(const StringArray& Arguments)
+{
+	int index = Arguments.indexOf("--seconds");
+	if (index != -1)
+		seconds = jmax(0.1, Arguments[index+1].getDoubleValue());
+
+	index = Arguments.indexOf("--warmup");
+	if (index != -1)
+		warmup = jmax(0.0, Arguments[index+1].getDoubleValue());
+
+	index = Arguments.indexOf("--threads");
+	if (index != -1)
+		threads = jlimit(1, 64, Arguments[index+1].getIntValue());
+
+	index = Arguments.indexOf("--rate");
+	if (index != -1)
+		rate = jmax(0, Arguments[index+1].getIntValue());
+
+	index = Arguments.indexOf("--bundle");
+	if (index != -1)
+		bundle = jlimit(1, MAX_BUNDLE, Arguments[index+1].getIntValue());
+
+	index = Arguments.indexOf("--arguments");
+	if (index != -1)
+		arguments = jlimit(0, MAX_ARGUMENTS, Arguments[index+1].getIntValue());
+
+	index = Arguments.indexOf("--shape");
+	if (index != -1)
+		shape = Arguments[index+1] == "random" ? SHAPE_RANDOM : (Arguments[index+1] == "outside" ? SHAPE_OUTSIDE : SHAPE_CONTINUOUS);
+
+	index = Arguments.indexOf("--output");
+	if (index != -1)
+		outputPath = Arguments[index+1].unquoted();
+}
+
+String BenchmarkSettings::toJson() const
+{
+	return "{\"seconds\": " + String(seconds) + ", \"warmup\": " + String(warmup) + ", \"threads\": " + String(threads)
+		+ ", \"rate\": " + String(rate) + ", \"bundle\": " + String(bundle) + ", \"arguments\": " + String(arguments)
+		+ ", \"shape\": \"" + getShapeName(shape) + "\"}";
+}
+
+//A UDP input node of the engine the generators can send to
+struct BenchmarkTarget
+{
+	IpEndpointName endpoint;
+	std::string address;
+	int numberOfValues;
+};
+
+//Sends packets to the targets in turn, starting at its own index so the threads spread over them
+class LoadGenerator : public Thread
+{
+public:
+	LoadGenerator(int Index, const vector<BenchmarkTarget>& Targets, const BenchmarkSettings& Settings, float Min, float Max)
+		: Thread("OscCalibrator load generator"), index(Index), targets(Targets), settings(Settings),
+		min(Min), span(Max-Min), measuring(false), cpuSeconds(0), random(Time::getHighResolutionTicks() + Index)
+	{
+	}
+
+	~LoadGenerator()
+	{
+		stopThread(2000);
+	}
+
+	//Starts timing the CPU used by this thread, which is taken off the engine's
+	void startMeasuring() {measuring=true;};
+	double getCpuSeconds() {return cpuSeconds;}; //once stopped
+	int getNumberOfSent() {return sent.get();};
+
+	void run()
+	{
+		UdpSocket socket;
+		HeapBlock<char> buffer(GENERATOR_BUFFER_SIZE);
+		double phase = index;
+		unsigned int next = index;
+
+		int64 start = Time::getHighResolutionTicks();
+		int64 ticksPerPacket = settings.rate > 0 ? Time::getHighResolutionTicksPerSecond() / settings.rate : 0;
+		int64 packets = 0;
+
+		bool measured = false;
+		double startCpu = 0;
+
+		while (!threadShouldExit())
+		{
+			if (measuring && !measured)
+			{
+				startCpu = getThreadCpuSeconds();
+				measured = true;
+			}
+
+			if (ticksPerPacket > 0)
+			{
+				int64 wait = start + packets*ticksPerPacket - Time::getHighResolutionTicks();
+				if (wait > 0)
+				{
+					int ms = (int)(Time::highResolutionTicksToSeconds(wait) * 1000);
+					if (ms > 2)
+						Thread::sleep(ms-1);
+					else
+						Thread::yield();
+
+					continue;
+				}
+			}
+
+			const BenchmarkTarget& target = targets[next++ % targets.size()];
+			int numberOfValues = settings.arguments > 0 ? settings.arguments : target.numberOfValues;
+
+			try
+			{
+				osc::OutboundPacketStream p(buffer, GENERATOR_BUFFER_SIZE);
+
+				if (settings.bundle > 1)
+					p << osc::BeginBundleImmediate;
+
+				for (int i=0; i<settings.bundle; i++)
+				{
+					p << osc::BeginMessage(target.address.c_str());
+					for (int j=0; j<numberOfValues; j++)
+						p << getValue(j, phase);
+					p << osc::EndMessage;
+
+					phase += PHASE_STEP;
+				}
+
+				if (settings.bundle > 1)
+					p << osc::EndBundle;
+
+				socket.SendTo(target.endpoint, p.Data(), p.Size());
+				++sent;
+			}
+			catch (osc::OutOfBufferMemoryException&)
+			{
+				Logger::writeToLog("OscCalibrator: the benchmark packets don't fit " + String(GENERATOR_BUFFER_SIZE) + " bytes");
+				break;
+			}
+			catch (std::runtime_error&)
+			{
+				//Datagrams the network refuses (e.g. a full send buffer) count as not sent
+			}
+
+			packets++;
+		}
+
+		if (measured)
+			cpuSeconds = getThreadCpuSeconds() - startCpu;
+	}
+
+	juce_UseDebuggingNewOperator
+
+private:
+	int index;
+	const vector<BenchmarkTarget>& targets;
+	const BenchmarkSettings& settings;
+	float min;
+	float span;
+	volatile bool measuring;
+	double cpuSeconds;
+	Atomic<int> sent;
+	Random random;
+
+	float getValue(int ValueIndex, double Phase)
+	{
+		switch (settings.shape)
+		{
+		case SHAPE_RANDOM:
+			return min + span*random.nextFloat();
+		case SHAPE_OUTSIDE:
+			return min - span + 3*span*random.nextFloat(); //two thirds outside of the range
+		default:
+			return min + span*(0.5f + 0.5f*(float)sin(Phase*(1 + 0.37*ValueIndex)));
+		}
+	}
+};
+
+//Whether the packets for Target fit GENERATOR_BUFFER_SIZE. Larger ones would arrive truncated and
+//still be counted as received.
+static bool packetFits(const BenchmarkTarget& Target, const BenchmarkSettings& Settings, char* Buffer)
+{
+	int numberOfValues = Settings.arguments > 0 ? Settings.arguments : Target.numberOfValues;
+
+	try
+	{
+		osc::OutboundPacketStream p(Buffer, GENERATOR_BUFFER_SIZE);
+
+		if (Settings.bundle > 1)
+			p << osc::BeginBundleImmediate;
+
+		for (int i=0; i<Settings.bundle; i++)
+		{
+			p << osc::BeginMessage(Target.address.c_str());
+			for (int j=0; j<numberOfValues; j++)
+				p << 0.0f;
+			p << osc::EndMessage;
+		}
+
+		if (Settings.bundle > 1)
+			p << osc::EndBundle;
+	}
+	catch (osc::OutOfBufferMemoryException&)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//The UDP inputs with a literal address, and the range of the calibration points of all calibrators
+static void getTargets(Engine* TheEngine, vector<BenchmarkTarget>& Targets, float& Min, float& Max)
+{
+	const ScopedLock myScopedLock (TheEngine->getLock());
+
+	bool bounded = false;
+
+	for (int i=0; i<TheEngine->getNumberOfNodes(); i++)
+	{
+		EngineNode* node = TheEngine->getNodeInOrder(i);
+
+		if (node->getType()==INPUTNODE)
+		{
+			OscInputEngineNode* input = (OscInputEngineNode*)node;
+			if (input->isTcp() || input->getRing().isNotEmpty() || input->getPort() <= 0
+				|| input->getAddress().isEmpty() || input->getAddress().containsAnyOf("*?"))
+				continue;
+
+			BenchmarkTarget target;
+			target.endpoint = IpEndpointName("127.0.0.1", input->getPort());
+			target.address = input->getAddress().toCString();
+			target.numberOfValues = jmax(1, input->getNumberOfOutputs());
+			Targets.push_back(target);
+		}
+
+		if (node->getType()==CALIBRATORNODE)
+		{
+			vector<double> min, max;
+			if (!((CalibratorEngineNode*)node)->getQhullCalibrator()->getBounds(min, max))
+				continue;
+
+			for (unsigned int j=0; j<min.size(); j++)
+			{
+				Min = bounded ? jmin(Min, (float)min[j]) : (float)min[j];
+				Max = bounded ? jmax(Max, (float)max[j]) : (float)max[j];
+				bounded = true;
+			}
+		}
+	}
+
+	if (!bounded)
+	{
+		Min = 0;
+		Max = 1;
+	}
+	else if (Max <= Min)
+		Max = Min + 1;
+}
+
+static String getNodesJson(Engine* TheEngine, int& QueueDrops)
+{
+	const ScopedLock myScopedLock (TheEngine->getLock());
+
+	String json;
+	QueueDrops = 0;
+
+	for (int i=0; i<TheEngine->getNumberOfNodes(); i++)
+	{
+		EngineNode* node = TheEngine->getNodeInOrder(i);
+		ProfileCounter& profile = node->getProcessProfile();
+		LatencyHistogram& latency = node->getLatency();
+
+		const char* type = node->getType()==INPUTNODE ? "input" : (node->getType()==CALIBRATORNODE ? "calibrator" : "output");
+
+		if (node->getType()==INPUTNODE)
+			QueueDrops += TheEngine->oscManager.getNumberOfDroppedMessages(node);
+
+		json << (i > 0 ? ",\n" : "") << "    {\"id\": " << node->getID() << ", \"type\": \"" << type << "\", \"calls\": " << profile.getCalls()
+			<< ", \"avg_us\": " << String(profile.getAverageMicroseconds(), 2) << ", \"max_us\": " << String(profile.getMaxMicroseconds(), 2)
+			<< ", \"latency_us\": {\"p50\": " << latency.getPercentile(0.5) << ", \"p99\": " << latency.getPercentile(0.99)
+			<< ", \"p999\": " << latency.getPercentile(0.999) << "}";
+
+		if (node->getType()==CALIBRATORNODE)
+		{
+			json << ", \"paths\": {";
+
+			bool first = true;
+			for (int j=0; j<NUMBER_OF_CALIBRATION_PATHS; j++)
+			{
+				ProfileCounter& path = ((CalibratorEngineNode*)node)->getPathProfile(j);
+				if (path.getCalls() == 0)
+					continue;
+
+				json << (first ? "" : ", ") << "\"" << QhullCalibrator::getPathName(j) << "\": {\"calls\": " << path.getCalls()
+					<< ", \"avg_us\": " << String(path.getAverageMicroseconds(), 2) << "}";
+				first = false;
+			}
+
+			json << "}";
+		}
+
+		json << "}";
+	}
+
+	return json;
+}
+
+static int getNumberOfSent(OwnedArray<LoadGenerator>& Generators)
+{
+	int result = 0;
+	for (int i=0; i<Generators.size(); i++)
+		result += Generators[i]->getNumberOfSent();
+
+	return result;
+}
+
+bool runBenchmark(Engine* TheEngine, const BenchmarkSettings& Settings)
+{
+	vector<BenchmarkTarget> targets;
+	float min, max;
+	getTargets(TheEngine, targets, min, max);
+
+	if (targets.empty())
+	{
+		Logger::writeToLog("OscCalibrator: the benchmark needs a UDP input node with an address without wildcards");
+		return false;
+	}
+
+	HeapBlock<char> buffer(GENERATOR_BUFFER_SIZE);
+	for (unsigned int i=0; i<targets.size(); i++)
+	{
+		if (!packetFits(targets[i], Settings, buffer))
+		{
+			Logger::writeToLog("OscCalibrator: the benchmark packets for " + String(targets[i].address.c_str()) + " don't fit "
+				+ String(GENERATOR_BUFFER_SIZE) + " bytes, use fewer --bundle messages or --arguments");
+			return false;
+		}
+	}
+
+	OscManager& oscManager = TheEngine->oscManager;
+	int64 receivedBefore = oscManager.getNumberOfReceivedPackets();
+
+	Logger::writeToLog("OscCalibrator: benchmarking " + String((int)targets.size()) + " inputs with " + String(Settings.threads)
+		+ " threads, " + String(Settings.warmup) + " s warmup and " + String(Settings.seconds) + " s measured");
+
+	OwnedArray<LoadGenerator> generators;
+	for (int i=0; i<Settings.threads; i++)
+	{
+		generators.add(new LoadGenerator(i, targets, Settings, min, max));
+		generators.getLast()->startThread();
+	}
+
+	Thread::sleep((int)(Settings.warmup * 1000));
+
+	//Measuring starts with clear statistics, so they only cover the steady state
+	TheEngine->resetStatistics();
+
+	int64 startTicks = Time::getHighResolutionTicks();
+	double startCpu = getProcessCpuSeconds();
+	int64 startReceived = oscManager.getNumberOfReceivedPackets();
+	int startSent = getNumberOfSent(generators);
+
+	for (int i=0; i<generators.size(); i++)
+		generators[i]->startMeasuring();
+
+	Thread::sleep((int)(Settings.seconds * 1000));
+
+	int64 endTicks = Time::getHighResolutionTicks();
+	int64 endReceived = oscManager.getNumberOfReceivedPackets();
+	int endSent = getNumberOfSent(generators);
+
+	double generatorCpu = 0;
+	for (int i=0; i<generators.size(); i++)
+	{
+		generators[i]->stopThread(2000);
+		generatorCpu += generators[i]->getCpuSeconds();
+	}
+
+	double cpuSeconds = jmax(0.0, getProcessCpuSeconds() - startCpu - generatorCpu);
+	double cpuWindow = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+	//Whatever is still in the socket buffers and queues counts as received, not dropped
+	int64 received = oscManager.getNumberOfReceivedPackets();
+	double drainStart = Time::getMillisecondCounterHiRes();
+	while (Time::getMillisecondCounterHiRes() - drainStart < DRAIN_TIMEOUT)
+	{
+		Thread::sleep(100);
+
+		int64 now = oscManager.getNumberOfReceivedPackets();
+		if (now == received)
+			break;
+		received = now;
+	}
+
+	int sent = getNumberOfSent(generators);
+	received -= receivedBefore;
+
+	double seconds = Time::highResolutionTicksToSeconds(endTicks - startTicks);
+	double packetsPerSecond = seconds > 0 ? (endReceived - startReceived) / seconds : 0;
+	int64 measuredPackets = jmax((int64)1, endReceived - startReceived);
+
+	int queueDrops;
+	String nodes = getNodesJson(TheEngine, queueDrops);
+
+	ProfileCounter& passes = TheEngine->getPassProfile();
+	LatencyHistogram& latency = oscManager.getSendLatency();
+
+	String json;
+	json << "{\n  \"version\": \"" << JUCEApplication::getInstance()->getApplicationVersion() << "\",\n"
+		<< "  \"settings\": " << Settings.toJson() << ",\n"
+		<< "  \"inputs\": " << (int)targets.size() << ",\n"
+		<< "  \"range\": [" << min << ", " << max << "],\n"
+		<< "  \"measured_seconds\": " << String(seconds, 3) << ",\n"
+		<< "  \"sent_packets\": " << sent << ",\n"
+		<< "  \"received_packets\": " << String(received) << ",\n"
+		<< "  \"dropped_packets\": " << String(jmax((int64)0, sent - received)) << ",\n"
+		<< "  \"queue_drops\": " << queueDrops << ",\n"
+		<< "  \"packets_per_second\": " << String(packetsPerSecond, 0) << ",\n"
+		<< "  \"messages_per_second\": " << String(packetsPerSecond * Settings.bundle, 0) << ",\n"
+		<< "  \"sent_per_second\": " << String(seconds > 0 ? (endSent - startSent) / seconds : 0, 0) << ",\n"
+		<< "  \"passes\": {\"calls\": " << passes.getCalls() << ", \"avg_us\": " << String(passes.getAverageMicroseconds(), 2)
+			<< ", \"max_us\": " << String(passes.getMaxMicroseconds(), 2) << "},\n"
+		<< "  \"output_messages\": " << String(latency.getCount()) << ",\n"
+		<< "  \"cpu\": {\"seconds\": " << String(cpuSeconds, 3)
+			<< ", \"one_core_percent\": " << String(cpuWindow > 0 ? 100 * cpuSeconds / cpuWindow : 0, 1)
+			<< ", \"all_cores_percent\": " << String(cpuWindow > 0 ? 100 * cpuSeconds / cpuWindow / SystemStats::getNumCpus() : 0, 1)
+			<< ", \"us_per_packet\": " << String(1e6 * cpuSeconds / measuredPackets, 2) << "},\n"
+		<< "  \"latency_us\": {\"p50\": " << latency.getPercentile(0.5) << ", \"p99\": " << latency.getPercentile(0.99)
+			<< ", \"p999\": " << latency.getPercentile(0.999) << ", \"max\": " << latency.getMax() << "},\n"
+		<< "  \"nodes\": [\n" << nodes << "\n  ]\n}\n";
+
+	Logger::writeToLog(json);
+
+	if (Settings.outputPath.isNotEmpty())
+	{
+		File outputFile (File::getCurrentWorkingDirectory().getChildFile(Settings.outputPath));
+		if (!outputFile.replaceWithText(json))
+		{
+			Logger::writeToLog("OscCalibrator: unable to write the benchmark report " + outputFile.getFullPathName());
+			return false;
+		}
+	}
+
+	return true;
+}
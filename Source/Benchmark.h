@@ -0,0 +1,50 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "Engine.h"
+
+#define SHAPE_CONTINUOUS 0 //slow sweeps through the calibrated range, like a tracked sensor
+#define SHAPE_RANDOM 1 //uniformly random values within the calibrated range
+#define SHAPE_OUTSIDE 2 //values mostly beyond the calibrated range, exercising extrapolation
+
+struct BenchmarkSettings
+{
+	BenchmarkSettings();
+
+	//"--seconds <s>" "--warmup <s>" "--threads <n>" "--rate <packets per second and thread, 0 for max>"
+	//"--bundle <messages per packet>" "--arguments <n>" "--shape continuous|random|outside" "--output <file>"
+	void parse(const StringArray& Arguments);
+	String toJson() const;
+
+	double seconds;
+	double warmup;
+	int threads;
+	int rate;
+	int bundle; //1 sends plain messages
+	int arguments; //0 sends as many as the input node has outputs
+	int shape;
+	String outputPath;
+};
+
+//Drives the UDP inputs of a running engine with synthetic OSC traffic sent to the local host
+//from a number of generator threads, and measures it end to end: packets sent, received and
+//dropped, the passes over the graph, the CPU time of the engine (the process without the
+//generators), the receive to send latency and the per node processing statistics.
+//The report is JSON, written to the log and to the output file if one is given.
+//Returns false if the engine has no input to drive, the packets would be larger than the inputs
+//receive (4096 bytes), or the report can't be written.
+bool runBenchmark(Engine* TheEngine, const BenchmarkSettings& Settings);
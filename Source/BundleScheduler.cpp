@@ -0,0 +1,147 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "BundleScheduler.h"
+#include "OscManager.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+
+BundleScheduler::BundleScheduler() : Thread("BundleScheduler")
+{
+	nextSequence = 0;
+}
+
+BundleScheduler::~BundleScheduler()
+{
+	for (unsigned int i=0; i<heap.size(); i++)
+		delete heap[i];
+}
+
+double BundleScheduler::getDelay(osc::uint64 TimeTag)
+{
+	//Time tag 1 means "immediately"
+	if (TimeTag <= 1)
+		return 0;
+
+	//NTP time: seconds since 1900 in the upper 32 bits, fraction of a second in the lower 32 bits
+	const int64 secondsFrom1900To1970 = (int64) 2208988800LL;
+	int64 seconds = (int64) (TimeTag >> 32) - secondsFrom1900To1970;
+	double milliseconds = (double) (TimeTag & 0xFFFFFFFF) * 1000.0 / 4294967296.0;
+
+	double delay = (double) (seconds*1000 - Time::currentTimeMillis()) + milliseconds;
+
+	if (delay <= 0 || delay > MAX_TIME_TAG_DELAY)
+		return 0;
+
+	return delay;
+}
+
+bool BundleScheduler::isLater(const ScheduledBundle* a, const ScheduledBundle* b)
+{
+	if (a->due != b->due)
+		return a->due > b->due;
+	else
+		return a->sequence > b->sequence;
+}
+
+bool BundleScheduler::schedule(PortListener* Listener, const char* Data, int Size, double Delay)
+{
+	ScheduledBundle* bundle = new ScheduledBundle();
+	bundle->due = Time::getMillisecondCounterHiRes() + Delay;
+	bundle->listener = Listener;
+	bundle->data.assign(Data, Data+Size);
+
+	{
+		const ScopedLock myScopedLock (cs);
+
+		if (heap.size() >= MAX_SCHEDULED_BUNDLES)
+		{
+			delete bundle;
+			return false;
+		}
+
+		bundle->sequence = nextSequence++;
+
+		heap.push_back(bundle);
+		push_heap(heap.begin(), heap.end(), isLater);
+	}
+
+	notify();
+	return true;
+}
+
+void BundleScheduler::cancel(PortListener* Listener)
+{
+	const ScopedLock dispatching (dispatchLock);
+	const ScopedLock myScopedLock (cs);
+
+	unsigned int j=0;
+	for (unsigned int i=0; i<heap.size(); i++)
+	{
+		if (heap[i]->listener == Listener)
+			delete heap[i];
+		else
+			heap[j++] = heap[i];
+	}
+
+	heap.resize(j);
+	make_heap(heap.begin(), heap.end(), isLater);
+}
+
+void BundleScheduler::run()
+{
+	TraceThread traceThread;
+
+	while (!threadShouldExit())
+	{
+		double delay = -1;
+
+		{
+			//Held from taking the bundle off the heap until it is dispatched, so cancel can't miss it
+			const ScopedLock dispatching (dispatchLock);
+			ScheduledBundle* bundle = 0;
+
+			{
+				const ScopedLock myScopedLock (cs);
+
+				if (!heap.empty())
+				{
+					delay = heap.front()->due - Time::getMillisecondCounterHiRes();
+
+					if (delay <= 0)
+					{
+						pop_heap(heap.begin(), heap.end(), isLater);
+						bundle = heap.back();
+						heap.pop_back();
+					}
+				}
+			}
+
+			if (bundle)
+			{
+				bundle->listener->dispatchScheduledBundle(&bundle->data[0], (int)bundle->data.size());
+				delete bundle;
+				continue;
+			}
+		}
+
+		if (delay < 0)
+			wait(-1);
+		else if (delay > 2)
+			wait((int)delay - 1);
+		else
+			Thread::yield();
+	}
+}
@@ -0,0 +1,68 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "../oscpack/osc/OscTypes.h"
+#include "..\juce\juce_amalgamated.h"
+
+#include <vector>
+using namespace std;
+
+class PortListener;
+
+#define MAX_SCHEDULED_BUNDLES 4096 //bundles beyond this are dispatched as they arrive
+#define MAX_TIME_TAG_DELAY 10000 //ms; bundles further in the future are dispatched as they arrive (the sender's clock is most probably off)
+
+//Holds received bundles with a time tag in the future and passes them back to their listener
+//at that time, so the receiving threads never wait. The pending bundles are kept in a heap
+//ordered by due time; this thread sleeps until the first one is due and spins the last
+//millisecond for a precise dispatch.
+class BundleScheduler : public Thread
+{
+public:
+	BundleScheduler();
+	~BundleScheduler();
+
+	//Milliseconds until the NTP time tag, 0 if it is due already or shouldn't be waited for
+	static double getDelay(osc::uint64 TimeTag);
+
+	//Copies the bundle, false if it has to be dispatched now because too many are pending
+	bool schedule(PortListener* Listener, const char* Data, int Size, double Delay);
+
+	//Drops the pending bundles of a listener that is being deleted, and waits for one being
+	//dispatched to it. Must not be called with the engine lock held.
+	void cancel(PortListener* Listener);
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	struct ScheduledBundle
+	{
+		double due; //Time::getMillisecondCounterHiRes
+		int64 sequence; //keeps bundles with the same due time in arrival order
+		PortListener* listener;
+		vector<char> data;
+	};
+
+	static bool isLater(const ScheduledBundle* a, const ScheduledBundle* b);
+
+	vector<ScheduledBundle*> heap;
+	int64 nextSequence;
+
+	CriticalSection cs; //the heap
+	CriticalSection dispatchLock; //held while a bundle is dispatched
+};
@@ -16,16 +16,17 @@
 #include "CalibratorNode.h"
 #include "MainComponent.h"
 
-CalibratorConfigurator::CalibratorConfigurator (int NumberOfInputs, int NumberOfOutputs, CalibratorNode* theCalibratorNode)
+CalibratorConfigurator::CalibratorConfigurator (CalibratorEngineNode* theEngineNode, CalibratorNode* theCalibratorNode)
     : addButton (0),
       label (0),
       numberLabel (0),
       clearButton (0)
 {
 
+	engineNode = theEngineNode;
 	calibratorNode = theCalibratorNode;
-	numberOfInputs=NumberOfInputs;
-	numberOfOutputs=NumberOfOutputs;
+	numberOfInputs=engineNode->getNumberOfInputs();
+	numberOfOutputs=engineNode->getNumberOfOutputs();
 
 	for (int i=0; i<numberOfOutputs; i++)
 	{
@@ -34,15 +35,6 @@ CalibratorConfigurator::CalibratorConfigurator (int NumberOfInputs, int NumberOf
 		addAndMakeVisible (parameterSlider);
 	}
 
-//	calibrator = new Calibrator(numberOfInputs, numberOfOutputs);
-	qhullCalibrator = new QhullCalibrator(numberOfInputs, numberOfOutputs);
-
-	for (int i=0; i<numberOfInputs; i++)
-		inputValues.push_back(0);
-
-	for (int i=0; i<numberOfOutputs; i++)
-		outputValues.push_back(0);
-
     addAndMakeVisible (addButton = new TextButton (T("new button")));
     addButton->setButtonText (T("Add calibration point"));
     addButton->addListener (this);
@@ -80,7 +72,7 @@ CalibratorConfigurator::CalibratorConfigurator (int NumberOfInputs, int NumberOf
     //[UserPreSize]
     //[/UserPreSize]
 
-    setSize (400, 70+50*NumberOfOutputs);
+    setSize (400, 70+50*numberOfOutputs);
 
     //[Constructor] You can add your own custom stuff here..
     //[/Constructor]
@@ -103,9 +95,6 @@ CalibratorConfigurator::~CalibratorConfigurator()
     deleteAndZero (numberLabel);
     deleteAndZero (clearButton);
 
-//	delete calibrator;
-	delete qhullCalibrator;
-
     //[Destructor]. You can add your own custom destruction code here..
     //[/Destructor]
 }
@@ -139,39 +128,25 @@ void CalibratorConfigurator::resized()
 
 void CalibratorConfigurator::buttonClicked (Button* buttonThatWasClicked)
 {
+	const ScopedLock myScopedLock (((MainComponent*)calibratorNode->getParentComponent())->engine.getLock());
+
     if (buttonThatWasClicked == addButton)
     {
-		vector<double> point;
-		for (int i=0; i<numberOfInputs; i++)
-		{
-			point.push_back((double)inputValues[i]);
-		}
-
 		vector<double> configuration;
 		for (unsigned int i=0; i<parameterSliders.size(); i++)
 		{
 			configuration.push_back(parameterSliders[i]->getValue());
 		}
 
-		CalibrationPoint cp(point, configuration);
-		//calibrator->addCalibrationPoint(cp);
-		qhullCalibrator->addCalibrationPoint(cp);
-		qhullCalibrator->tryToPerformTriangulation();
+		engineNode->addCalibrationPoint(configuration);
 
-		numberLabel->setText(String(qhullCalibrator->getNumberOfCalibrationPoints()),false);
+		numberLabel->setText(String(engineNode->getQhullCalibrator()->getNumberOfCalibrationPoints()),false);
     }
     else if (buttonThatWasClicked == clearButton)
     {
-        if (qhullCalibrator)
-		{
-		//	delete calibrator;
-		//	calibrator = new Calibrator(numberOfInputs, numberOfOutputs);
+		engineNode->clearCalibration();
 
-			delete qhullCalibrator;
-			qhullCalibrator = new QhullCalibrator(numberOfInputs, numberOfOutputs);
-		}
-
-		numberLabel->setText(String(qhullCalibrator->getNumberOfCalibrationPoints()),false);
+		numberLabel->setText(String(engineNode->getQhullCalibrator()->getNumberOfCalibrationPoints()),false);
     }
 }
 
@@ -182,63 +157,61 @@ void CalibratorConfigurator::setParameterLabel(int Index, String Text)
 		parameterSliders[Index]->setLabel(Text);
 }
 
-void CalibratorConfigurator::setInputValue(int Index, float Value)
+void CalibratorConfigurator::beginConfiguring()
 {
-	if (Index>=0 && Index<numberOfInputs)
-		inputValues[Index]=Value;
-}
+	const ScopedLock myScopedLock (((MainComponent*)calibratorNode->getParentComponent())->engine.getLock());
 
-float CalibratorConfigurator::getOutputValue(int Index)
-{
-	if (Index>=0 && Index<numberOfOutputs)
-		return outputValues[Index];
-	else return 0;
+	for (int i=0; i<numberOfOutputs; i++)
+		engineNode->setManualValue(i, engineNode->getOutputValue(i));
+
+	engineNode->setManual(true);
+
+	for (int i=0; i<numberOfOutputs; i++)
+	{
+		parameterSliders[i]->setRange(engineNode->getOutputMin(i), engineNode->getOutputMax(i), engineNode->getMinClip(i), engineNode->getMaxClip(i));
+		parameterSliders[i]->setValue((double)engineNode->getOutputValue(i));
+	}
+
+	setCalibrationPointsNumber(engineNode->getQhullCalibrator()->getNumberOfCalibrationPoints());
+
+	startTimer(40);
 }
 
-void CalibratorConfigurator::process()
+void CalibratorConfigurator::endConfiguring()
 {
-	if (isShowing())
+	stopTimer();
+
+	const ScopedLock myScopedLock (((MainComponent*)calibratorNode->getParentComponent())->engine.getLock());
+
+	for (int i=0; i<numberOfOutputs; i++)
 	{
-		for (unsigned int i=0; i<parameterSliders.size(); i++)
-		{
-			if (parameterSliders[i]->remoteControl)
-			{
-				parameterSliders[i]->setValue(parameterSliders[i]->remoteNode->getOutputValue(parameterSliders[i]->remoteOutputIndex));
-				outputValues[i] = parameterSliders[i]->remoteNode->getOutputValue(parameterSliders[i]->remoteOutputIndex);
-			}
-			else
-				outputValues[i] =(float)parameterSliders[i]->getValue();
-		}
+		configureRemote(i, false, 0, -1);
+		engineNode->setRange(i, (float)parameterSliders[i]->getMin(), (float)parameterSliders[i]->getMax(), parameterSliders[i]->getMinClip(), parameterSliders[i]->getMaxClip());
 	}
-	else
-	{
-		vector<double> point;
-		for (int i=0; i<numberOfInputs; i++)
-		{
-			point.push_back((double)inputValues[i]);
-		}
-		
-		vector<double> result;
-		result = qhullCalibrator->getInterpolated(point);
 
-		if (result.size())
-			for (int i=0; i<numberOfOutputs; i++)
-			{
-				if (parameterSliders[i]->getMinClip() && result[i]<parameterSliders[i]->getMin())
-					result[i] = parameterSliders[i]->getMin();
+	engineNode->setManual(false);
 
-				if (parameterSliders[i]->getMaxClip() && result[i]>parameterSliders[i]->getMax())
-					result[i] = parameterSliders[i]->getMax();
+	//The calibration or the output ranges might have changed
+	engineNode->markUpdated();
+}
 
-				outputValues[i] = (float)result[i];
-			}
-	}
+void CalibratorConfigurator::parameterChanged()
+{
+	Engine* engine = &((MainComponent*)calibratorNode->getParentComponent())->engine;
+
+	const ScopedLock myScopedLock (engine->getLock());
+
+	for (int i=0; i<numberOfOutputs; i++)
+		engineNode->setManualValue(i, (float)parameterSliders[i]->getValue());
+
+	engine->process();
 }
 
-void CalibratorConfigurator::configureOutput(int index, float min, float max, float value, bool minClip, bool maxClip)
+void CalibratorConfigurator::timerCallback() //The sliders of remote controlled parameters follow the outputs of the engine node
 {
-	setRange(index, min, max, minClip, maxClip);
-	setOutputValue(index, value); 
+	for (int i=0; i<numberOfOutputs; i++)
+		if (parameterSliders[i]->remoteControl)
+			parameterSliders[i]->setValue(engineNode->getOutputValue(i));
 }
 
 void CalibratorConfigurator::configureRemote(int ParameterIndex, bool RemoteControl, Node* RemoteNode, int RemoteOutputIndex)
@@ -246,6 +219,8 @@ void CalibratorConfigurator::configureRemote(int ParameterIndex, bool RemoteCont
 	parameterSliders[ParameterIndex]->remoteControl = RemoteControl;
 	parameterSliders[ParameterIndex]->remoteNode = RemoteNode;
 	parameterSliders[ParameterIndex]->remoteOutputIndex = RemoteOutputIndex;
+
+	engineNode->setRemote(ParameterIndex, (RemoteControl && RemoteNode) ? RemoteNode->getEngineNode() : 0, RemoteOutputIndex);
 }
 
 void CalibratorConfigurator::mouseDrag(const MouseEvent &e)
@@ -272,8 +247,8 @@ void CalibratorConfigurator::mouseUp (const MouseEvent &e)
 			setRemoteAdding(false);
 			setRemoteClearing(false);
 			MainComponent* mainComponent = (MainComponent*)calibratorNode->getParentComponent();
-			mainComponent->oscManager.setRemoteAdding(false, String(), 0);
-			mainComponent->oscManager.setRemoteClearing(false, String(), 0);
+			mainComponent->engine.oscManager.setRemoteAdding(false, 0);
+			mainComponent->engine.oscManager.setRemoteClearing(false, 0);
 		}
 	}
 }
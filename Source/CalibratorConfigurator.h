@@ -14,9 +14,9 @@
 #pragma once
 #include "..\juce\juce_amalgamated.h"
 #include "ParameterSlider.h"
-#include "QhullCalibrator\QhullCalibrator.h"
 #include "Node.h"
 #include "OscManager.h"
+#include "CalibratorEngineNode.h"
 
 #include "Pool.h"
 
@@ -27,11 +27,12 @@ class CalibratorNode;
 
 class CalibratorConfigurator  : public Component,
                                 public ButtonListener,
-								public DragAndDropContainer
+								public DragAndDropContainer,
+								public Timer
 {
 public:
     //==============================================================================
-    CalibratorConfigurator (int NumberOfInputs, int NumberOfOutputs, CalibratorNode* theCalibratorNode);
+    CalibratorConfigurator (CalibratorEngineNode* theEngineNode, CalibratorNode* theCalibratorNode);
     ~CalibratorConfigurator();
 
     //==============================================================================
@@ -44,24 +45,15 @@ public:
 
 	void setParameterLabel(int Index, String Text);
 
-	void setInputValue(int Index, float Value);
-	float getOutputValue(int Index);
-
-	void process();
-
 	CalibratorNode* getCalibratorNode() {return calibratorNode;};
-	float getOutputMin(int index) {return (float)parameterSliders[index]->getMin();};
-	float getOutputMax(int index) {return (float)parameterSliders[index]->getMax();};
-	void setOutputValue(int index, float value) {parameterSliders[index]->setValue((double)value);};
 	void setCalibrationPointsNumber(int number) {numberLabel->setText(String(number), false);};
 
-	bool getMinClip(int index) {return parameterSliders[index]->getMinClip();};
-	bool getMaxClip(int index) {return parameterSliders[index]->getMaxClip();};
-
-//	Calibrator* getCalibrator() {return calibrator;};
-	QhullCalibrator* getQhullCalibrator() {return qhullCalibrator;};
+	//Configuring: the sliders take over the outputs of the engine node while the configurator is open
+	void beginConfiguring();
+	void endConfiguring();
+	void parameterChanged();
 
-	void configureOutput(int index, float min, float max, float value, bool minClip, bool maxClip);
+	void timerCallback();
 
 	void configureRemote(int ParameterIndex, bool RemoteControl, Node* RemoteNode, int RemoteOutputIndex);
 
@@ -90,14 +82,8 @@ private:
 	int numberOfInputs;
 	int numberOfOutputs;
 
-	//Calibrator* calibrator;
-	QhullCalibrator* qhullCalibrator;
-	vector<float> inputValues;
-	vector<float> outputValues;
-	
+	CalibratorEngineNode* engineNode;
 	CalibratorNode* calibratorNode;
-	
-	void setRange(int index, float min, float max, bool minClip, bool maxClip) {parameterSliders[index]->setRange(min, max, minClip, maxClip);};
 
     //==============================================================================
     // (prevent copy constructor and operator= being generated..)
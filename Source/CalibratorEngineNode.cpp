@@ -0,0 +1,197 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "CalibratorEngineNode.h"
+#include "TraceRecorder.h"
+
+CalibratorEngineNode::CalibratorEngineNode(int NumberOfInputs, int NumberOfOutputs)
+{
+	type=CALIBRATORNODE;
+
+	setNumberOfInputs(NumberOfInputs);
+	setNumberOfOutputs(NumberOfOutputs);
+
+	qhullCalibrator = new QhullCalibrator(NumberOfInputs, NumberOfOutputs);
+	qhullCalibrator->setObserver(this);
+	stageStart = 0;
+
+	outputMin.resize(NumberOfOutputs, 0);
+	outputMax.resize(NumberOfOutputs, 1);
+	minClip.resize(NumberOfOutputs, false);
+	maxClip.resize(NumberOfOutputs, false);
+
+	manual=false;
+	manualValues.resize(NumberOfOutputs, 0);
+	remoteNodes.resize(NumberOfOutputs, 0);
+	remoteOutputIndices.resize(NumberOfOutputs, -1);
+}
+
+CalibratorEngineNode::~CalibratorEngineNode()
+{
+	delete qhullCalibrator;
+}
+
+void CalibratorEngineNode::process()
+{
+	if (manual)
+	{
+		for (int i=0; i<getNumberOfOutputs(); i++)
+		{
+			if (remoteNodes[i])
+				outputValues[i] = remoteNodes[i]->getOutputValue(remoteOutputIndices[i]);
+			else
+				outputValues[i] = manualValues[i];
+		}
+	}
+	else
+	{
+		vector<double> point;
+		for (int i=0; i<getNumberOfInputs(); i++)
+		{
+			point.push_back((double)inputValues[i]);
+		}
+
+		vector<double> result;
+
+		int64 start = Time::getHighResolutionTicks();
+		result = qhullCalibrator->getInterpolated(point);
+		pathProfiles[qhullCalibrator->getLastPath()].add(Time::getHighResolutionTicks() - start);
+
+		if (result.size())
+			for (int i=0; i<getNumberOfOutputs(); i++)
+			{
+				if (minClip[i] && result[i]<outputMin[i])
+					result[i] = outputMin[i];
+
+				if (maxClip[i] && result[i]>outputMax[i])
+					result[i] = outputMax[i];
+
+				outputValues[i] = (float)result[i];
+			}
+	}
+}
+
+void CalibratorEngineNode::resetStatistics()
+{
+	EngineNode::resetStatistics();
+
+	for (int i=0; i<NUMBER_OF_CALIBRATION_PATHS; i++)
+		pathProfiles[i].reset();
+}
+
+void CalibratorEngineNode::stageStarted(int Stage)
+{
+	stageStart = TraceRecorder::isRecording() ? Time::getHighResolutionTicks() : 0;
+}
+
+void CalibratorEngineNode::stageEnded(int Stage)
+{
+	if (stageStart != 0 && TraceRecorder::isRecording())
+		TraceRecorder::addEvent(QhullCalibrator::getStageName(Stage), stageStart, Time::getHighResolutionTicks(), id);
+}
+
+bool CalibratorEngineNode::takeUpdate()
+{
+	bool result = EngineNode::takeUpdate();
+
+	//While configuring, the outputs follow the manual values, so the calibrator is evaluated in every pass
+	if (manual)
+		result = true;
+
+	return result;
+}
+
+void CalibratorEngineNode::addCalibrationPoint(vector<double> Configuration)
+{
+	vector<double> point;
+	for (int i=0; i<getNumberOfInputs(); i++)
+	{
+		point.push_back((double)inputValues[i]);
+	}
+
+	CalibrationPoint cp(point, Configuration);
+	qhullCalibrator->addCalibrationPoint(cp);
+	qhullCalibrator->tryToPerformTriangulation();
+}
+
+void CalibratorEngineNode::clearCalibration()
+{
+	delete qhullCalibrator;
+	qhullCalibrator = new QhullCalibrator(getNumberOfInputs(), getNumberOfOutputs());
+	qhullCalibrator->setObserver(this);
+}
+
+void CalibratorEngineNode::setRange(int index, float min, float max, bool MinClip, bool MaxClip)
+{
+	outputMin[index]=min;
+	outputMax[index]=max;
+	minClip[index]=MinClip;
+	maxClip[index]=MaxClip;
+}
+
+void CalibratorEngineNode::setRemote(int index, EngineNode* RemoteNode, int RemoteOutputIndex)
+{
+	remoteNodes[index]=RemoteNode;
+	remoteOutputIndices[index]=RemoteOutputIndex;
+}
+
+void CalibratorEngineNode::readXml(const XmlElement& NodeElement)
+{
+	EngineNode::readXml(NodeElement);
+
+	joinPolicy = NodeElement.getIntAttribute("joinPolicy", JOIN_NONE);
+	joinTimeout = NodeElement.getIntAttribute("joinTimeout", 50);
+
+	int outputIndex=0;
+	forEachXmlChildElementWithTagName (NodeElement, e, "Output")
+	{
+		if (outputIndex<getNumberOfOutputs())
+		{
+			setRange(outputIndex, (float)e->getDoubleAttribute("min"), (float)e->getDoubleAttribute("max"), e->getBoolAttribute("minClip"), e->getBoolAttribute("maxClip"));
+			outputValues[outputIndex] = (float)e->getDoubleAttribute("value");
+			manualValues[outputIndex] = outputValues[outputIndex];
+		}
+
+		outputIndex++;
+	}
+
+	String configuration = NodeElement.getStringAttribute("calibration");
+	qhullCalibrator->setConfiguration(configuration.toCString());
+}
+
+void CalibratorEngineNode::writeXml(XmlElement& NodeElement)
+{
+	EngineNode::writeXml(NodeElement);
+
+	NodeElement.setAttribute("numberOfInputs", getNumberOfInputs());
+	NodeElement.setAttribute("numberOfOutputs", getNumberOfOutputs());
+
+	for (int i=0; i<getNumberOfInputs(); i++)
+		NodeElement.createNewChildElement("Input");
+
+	for (int i=0; i<getNumberOfOutputs(); i++)
+	{
+		XmlElement* connectorElement = NodeElement.createNewChildElement("Output");
+		connectorElement->setAttribute("value", outputValues[i]);
+		connectorElement->setAttribute("min", outputMin[i]);
+		connectorElement->setAttribute("max", outputMax[i]);
+		connectorElement->setAttribute("minClip", minClip[i]);
+		connectorElement->setAttribute("maxClip", maxClip[i]);
+	}
+
+	String calibration = qhullCalibrator->getConfiguration().c_str();
+	NodeElement.setAttribute("calibration", calibration);
+	NodeElement.setAttribute("joinPolicy", joinPolicy);
+	NodeElement.setAttribute("joinTimeout", joinTimeout);
+}
@@ -0,0 +1,75 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "EngineNode.h"
+#include "QhullCalibrator\QhullCalibrator.h"
+
+#include <vector>
+using namespace std;
+
+class CalibratorEngineNode : public EngineNode, public QhullCalibratorObserver
+{
+public:
+	CalibratorEngineNode(int NumberOfInputs, int NumberOfOutputs);
+	~CalibratorEngineNode();
+
+	void process();
+	bool takeUpdate();
+
+	QhullCalibrator* getQhullCalibrator() {return qhullCalibrator;};
+	//The time spent in the interpolation, per CALIBRATION_PATH
+	ProfileCounter& getPathProfile(int Path) {return pathProfiles[Path];};
+	void resetStatistics();
+	//Traces the stages of the interpolation
+	void stageStarted(int Stage);
+	void stageEnded(int Stage);
+	void addCalibrationPoint(vector<double> Configuration); //at the current input values
+	void clearCalibration();
+
+	float getOutputMin(int index) {return outputMin[index];};
+	float getOutputMax(int index) {return outputMax[index];};
+	bool getMinClip(int index) {return minClip[index];};
+	bool getMaxClip(int index) {return maxClip[index];};
+	void setRange(int index, float min, float max, bool MinClip, bool MaxClip);
+
+	//While the calibrator is being configured, the outputs follow the manually set values
+	//(or the outputs of remote nodes) instead of the interpolation
+	void setManual(bool State) {manual=State;};
+	bool isManual() {return manual;};
+	void setManualValue(int index, float value) {manualValues[index]=value;};
+	void setRemote(int index, EngineNode* RemoteNode, int RemoteOutputIndex);
+
+	void readXml(const XmlElement& NodeElement);
+	void writeXml(XmlElement& NodeElement);
+
+	juce_UseDebuggingNewOperator
+
+private:
+	QhullCalibrator* qhullCalibrator;
+	ProfileCounter pathProfiles[NUMBER_OF_CALIBRATION_PATHS];
+	int64 stageStart; //of the stage being traced, 0 if none
+
+	vector<float> outputMin;
+	vector<float> outputMax;
+	vector<bool> minClip;
+	vector<bool> maxClip;
+
+	bool manual;
+	vector<float> manualValues;
+	vector<EngineNode*> remoteNodes;
+	vector<int> remoteOutputIndices;
+};
@@ -15,13 +15,17 @@
 #include "CalibratorNode.h"
 #include "MainComponent.h"
 
-CalibratorNode::CalibratorNode ()
+CalibratorNode::CalibratorNode (CalibratorEngineNode* theEngineNode)
 {
 	title->setText("Calibrator", false);
 	title->addMouseListener(title->getParentComponent(), false);
 
-	configurator=0;
 	type=CALIBRATORNODE;
+	engineNode=theEngineNode;
+
+	createConnectors(engineNode->getNumberOfInputs(), engineNode->getNumberOfOutputs());
+
+	configurator = new CalibratorConfigurator(theEngineNode, this);
 }
 
 CalibratorNode::~CalibratorNode()
@@ -30,43 +34,23 @@ CalibratorNode::~CalibratorNode()
 		delete configurator;
 }
 
-void CalibratorNode::initialise(int NumberOfInputs, int NumberOfOutputs)
+StringArray CalibratorNode::getStatisticsLines()
 {
-	for (unsigned int i=0; i<outputConnectors.size(); i++)
-			deleteAndZero(outputConnectors[i]);
-		
-	outputConnectors.clear();
+	StringArray lines = Node::getStatisticsLines();
 
-	for (unsigned int i=0; i<inputConnectors.size(); i++)
-			deleteAndZero(inputConnectors[i]);
-		
-	inputConnectors.clear();
-
-	for (int i=0; i<NumberOfInputs; i++)
+	int slowest = -1;
+	for (int i=0; i<NUMBER_OF_CALIBRATION_PATHS; i++)
 	{
-		InputConnector* inputConnector = new InputConnector();
-		inputConnector->setID(i);
-		addAndMakeVisible(inputConnector);
-		inputConnectors.push_back(inputConnector);
-	}
+		ProfileCounter& path = getCalibratorEngineNode()->getPathProfile(i);
 
-	for (int i=0; i<NumberOfOutputs; i++)
-			{
-				OutputConnector* outputConnector = new OutputConnector();
-				outputConnector->setID(i);
-				addAndMakeVisible(outputConnector);
-				outputConnectors.push_back(outputConnector);
-			}
-
-	if (outputConnectors.size()==0 && inputConnectors.size()==0)
-	{
-		setSize(100, 40);
+		if (path.getCalls() > 0 && (slowest == -1 || path.getTotalMilliseconds() > getCalibratorEngineNode()->getPathProfile(slowest).getTotalMilliseconds()))
+			slowest = i;
 	}
-	else
-		setSize(100, 20+outputConnectors.size()*20+inputConnectors.size()*20);
 
+	if (slowest != -1)
+		lines.add(String(QhullCalibrator::getPathName(slowest)) + " " + String(getCalibratorEngineNode()->getPathProfile(slowest).getAverageMicroseconds(), 1) + " us");
 
-	configurator = new CalibratorConfigurator(NumberOfInputs, NumberOfOutputs, this);
+	return lines;
 }
 
 void CalibratorNode::mouseDoubleClick(const MouseEvent &e)
@@ -74,56 +58,43 @@ void CalibratorNode::mouseDoubleClick(const MouseEvent &e)
 	if (e.mods.isLeftButtonDown() && e.eventComponent==this)
 	{
 		for (int i=0; i<(int)outputConnectors.size(); i++)
-		{
 			configurator->setParameterLabel(i, outputConnectors[i]->getLabel());
-			configurator->setOutputValue(i, outputConnectors[i]->getValue());
-		}
 
-		configurator->setCalibrationPointsNumber(configurator->getQhullCalibrator()->getNumberOfCalibrationPoints());
+		configurator->beginConfiguring();
 
 		MainComponent* mainComponent = (MainComponent*)getParentComponent();
 		mainComponent->activeConfigurator = configurator;
 		DialogWindow::showModalDialog(title->getText()+" configuration", configurator, this, Colours::lightgrey, false);
 		mainComponent->activeConfigurator = 0;
 
-		for (int i = 0; i < this->getNumberOfOutputs(); i++)
-		{
-			configurator->parameterSliders[i]->remoteControl = false;
-			configurator->parameterSliders[i]->remoteNode = 0;
-			configurator->parameterSliders[i]->remoteOutputIndex = -1;
-		}
+		configurator->endConfiguring();
 
 		mainComponent->repaint();
 	}
 }
 
-void CalibratorNode::process()
+void CalibratorNode::mouseUp(const MouseEvent &e)
 {
-	for (unsigned int i=0; i<inputConnectors.size(); i++)
-		configurator->setInputValue(i, inputConnectors[i]->getValue());
+	if (e.mods == ModifierKeys::rightButtonModifier && e.eventComponent==this)
+	{
+		const int timeouts[] = {0, 10, 20, 50, 100, 250, 500};
 
-	configurator->process();
+		PopupMenu timeoutMenu;
+		for (int i=0; i<7; i++)
+			timeoutMenu.addItem (10+i, timeouts[i]==0 ? String("No timeout") : String(timeouts[i])+" ms", true, engineNode->getJoinTimeout()==timeouts[i]);
 
-	for (unsigned int i=0; i<outputConnectors.size(); i++)
-		outputConnectors[i]->setValue(configurator->getOutputValue(i));
-}
+		PopupMenu m;
+		m.addItem (1, "Evaluate on every input update", true, engineNode->getJoinPolicy()==JOIN_NONE);
+		m.addItem (2, "Wait for all connected inputs", true, engineNode->getJoinPolicy()==JOIN_ALL);
+		m.addSubMenu ("Join timeout", timeoutMenu, engineNode->getJoinPolicy()==JOIN_ALL);
 
-float CalibratorNode::getOutputMin(int index)
-{
-	return configurator->getOutputMin(index);
-}
-	
-float CalibratorNode::getOutputMax(int index)
-{
-	return configurator->getOutputMax(index);
-}
+		const int result = m.show();
 
-bool CalibratorNode::getMinClip(int index)
-{
-	return configurator->getMinClip(index);
+		if (result == 1)
+			engineNode->setJoinPolicy(JOIN_NONE);
+		else if (result == 2)
+			engineNode->setJoinPolicy(JOIN_ALL);
+		else if (result >= 10 && result < 17)
+			engineNode->setJoinTimeout(timeouts[result-10]);
+	}
 }
-	
-bool CalibratorNode::getMaxClip(int index)
-{
-	return configurator->getMaxClip(index);
-}
\ No newline at end of file
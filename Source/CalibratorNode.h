@@ -17,28 +17,23 @@
 #include "..\juce\juce_amalgamated.h"
 #include "Node.h"
 #include "CalibratorConfigurator.h"
+#include "CalibratorEngineNode.h"
 
 
 class CalibratorNode  : public Node
 {
 public:
     //==============================================================================
-    CalibratorNode ();
+    CalibratorNode (CalibratorEngineNode* theEngineNode);
     ~CalibratorNode();
 
-	void initialise(int NumberOfInputs, int NumberOfOutputs);
-
-	virtual void process();
-
 	void mouseDoubleClick(const MouseEvent &e);
-
-	float getOutputMin(int index);
-	float getOutputMax(int index);
-
-	bool getMinClip(int index);
-	bool getMaxClip(int index);
+	void mouseUp(const MouseEvent &e);
 
 	CalibratorConfigurator* getConfigurator() {return configurator;};
+	CalibratorEngineNode* getCalibratorEngineNode() {return (CalibratorEngineNode*)engineNode;};
+
+	StringArray getStatisticsLines(); //with the interpolation path that took the most time
 
     //==============================================================================
     juce_UseDebuggingNewOperator
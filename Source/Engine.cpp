@@ -0,0 +1,422 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Engine.h"
+
+Engine::Engine()
+{
+	listener=0;
+	oscManager.setEngine(this);
+	outputClock.setEngine(this);
+}
+
+Engine::~Engine()
+{
+	stop();
+	clear();
+}
+
+void Engine::start()
+{
+	oscManager.startThread();
+	outputClock.startThread();
+}
+
+void Engine::stop()
+{
+	oscManager.stop();
+	outputClock.stopThread(1000);
+}
+
+void Engine::addNode(EngineNode* node)
+{
+	const ScopedLock myScopedLock (cs);
+
+	graph.addNode(node);
+}
+
+void Engine::deleteNode(EngineNode* node)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (graph.getNode(node->getID())==node)
+	{
+		oscManager.unregisterReceiver(node);
+		graph.removeNode(node);
+		delete node;
+	}
+}
+
+void Engine::clear()
+{
+	const ScopedLock myScopedLock (cs);
+
+	for (int i=0; i<graph.getNumberOfNodes(); i++)
+	{
+		EngineNode* node = graph.getNodeInOrder(i);
+
+		oscManager.unregisterReceiver(node);
+		delete node;
+	}
+
+	graph.clear();
+}
+
+bool Engine::connect(const Connection& connection)
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.connect(connection);
+}
+
+bool Engine::disconnectInput(int NodeId, int InputId, Connection& removed)
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.disconnectInput(NodeId, InputId, removed);
+}
+
+vector<Connection> Engine::disconnectOutput(int NodeId, int OutputId)
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.disconnectOutput(NodeId, OutputId);
+}
+
+vector<Connection> Engine::disconnectNode(int NodeId)
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.disconnectNode(NodeId);
+}
+
+bool Engine::isOutputConnected(int NodeId, int OutputId)
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.isOutputConnected(NodeId, OutputId);
+}
+
+vector<Connection> Engine::getConnections()
+{
+	const ScopedLock myScopedLock (cs);
+
+	return graph.getConnections();
+}
+
+void Engine::process()
+{
+	const ScopedLock myScopedLock (cs);
+	TraceScope trace("process");
+	ScopedProfile profile(passProfile);
+
+	graph.process();
+	oscManager.flushOSC();
+	publishValues();
+}
+
+void Engine::processExpiredJoins()
+{
+	const ScopedLock myScopedLock (cs);
+	TraceScope trace("process joins");
+	ScopedProfile profile(passProfile);
+
+	graph.processExpiredJoins();
+	oscManager.flushOSC();
+	publishValues();
+}
+
+void Engine::setValueTable(const String& Name)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (Name == valueTable.getName())
+		return;
+
+	valueTable.close();
+	publishedOutputs.clear();
+
+	if (Name.isNotEmpty() && !valueTable.open(Name))
+		Logger::writeToLog("OscCalibrator: unable to open the shared value table " + Name);
+}
+
+String Engine::getLatencyReport()
+{
+	const ScopedLock myScopedLock (cs);
+
+	String report;
+
+	for (int i=0; i<graph.getNumberOfNodes(); i++)
+	{
+		EngineNode* node = graph.getNodeInOrder(i);
+		String name;
+
+		if (node->getType()==INPUTNODE)
+			name = "input " + ((OscInputEngineNode*)node)->getAddress();
+		else if (node->getType()==CALIBRATORNODE)
+			name = "calibrator";
+		else if (node->getType()==OUTPUTNODE)
+			name = "output " + ((OscOutputEngineNode*)node)->getAddress();
+
+		if (node->getLatency().getCount() > 0)
+			report << "node" << node->getID() << " " << name << ": " << node->getLatency().getSummary() << "\n";
+
+		if (node->getType()==OUTPUTNODE && ((OscOutputEngineNode*)node)->getSendLatency().getCount() > 0)
+			report << "node" << node->getID() << " " << name << " sent: " << ((OscOutputEngineNode*)node)->getSendLatency().getSummary() << "\n";
+	}
+
+	report << "all outputs sent: " << oscManager.getSendLatency().getSummary();
+
+	return report;
+}
+
+void Engine::resetStatistics()
+{
+	const ScopedLock myScopedLock (cs);
+
+	for (int i=0; i<graph.getNumberOfNodes(); i++)
+		graph.getNodeInOrder(i)->resetStatistics();
+
+	oscManager.getSendLatency().reset();
+	passProfile.reset();
+}
+
+static void addStatsMessage(vector<MemoryBlock>& Messages, osc::OutboundPacketStream& p)
+{
+	Messages.push_back(MemoryBlock(p.Data(), p.Size()));
+	p.Clear();
+}
+
+//Packs the messages into as few bundles of up to STATS_BUNDLE_SIZE bytes as they fit in
+static vector<vector<char> > packStatsBundles(const vector<MemoryBlock>& Messages)
+{
+	static const char bundleHeader[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1}; //time tag: immediately
+
+	vector<vector<char> > bundles;
+
+	for (unsigned int i=0; i<Messages.size(); i++)
+	{
+		int size = (int)Messages[i].getSize();
+
+		if (bundles.empty() || (int)bundles.back().size() + 4 + size > STATS_BUNDLE_SIZE)
+			bundles.push_back(vector<char>(bundleHeader, bundleHeader + sizeof(bundleHeader)));
+
+		vector<char>& bundle = bundles.back();
+		const char sizeBytes[4] = {(char)(size >> 24), (char)(size >> 16), (char)(size >> 8), (char)size};
+		bundle.insert(bundle.end(), sizeBytes, sizeBytes + 4);
+		bundle.insert(bundle.end(), (const char*)Messages[i].getData(), (const char*)Messages[i].getData() + size);
+	}
+
+	return bundles;
+}
+
+static const double statsPercentiles[3] = {0.5, 0.99, 0.999};
+
+void Engine::sendStatistics(UdpSocket* Socket, const IpEndpointName& To)
+{
+	vector<MemoryBlock> messages;
+	char buffer[512];
+	osc::OutboundPacketStream p(buffer, sizeof(buffer));
+
+	{
+		const ScopedLock myScopedLock (cs);
+
+		for (int i=0; i<graph.getNumberOfNodes(); i++)
+		{
+			EngineNode* node = graph.getNodeInOrder(i);
+			ProfileCounter& profile = node->getProcessProfile();
+			int latency[3];
+			node->getLatency().getPercentiles(statsPercentiles, latency, 3);
+
+			const char* type = node->getType()==INPUTNODE ? "input" : (node->getType()==CALIBRATORNODE ? "calibrator" : "output");
+
+			p << osc::BeginMessage(STATS_ADDRESS "/node") << node->getID() << type << profile.getCalls()
+				<< (float)profile.getAverageMicroseconds() << (float)profile.getMaxMicroseconds() << (float)profile.getTotalMilliseconds()
+				<< latency[0] << latency[1] << latency[2] << osc::EndMessage;
+			addStatsMessage(messages, p);
+
+			if (node->getType()==CALIBRATORNODE)
+			{
+				for (int j=0; j<NUMBER_OF_CALIBRATION_PATHS; j++)
+				{
+					ProfileCounter& path = ((CalibratorEngineNode*)node)->getPathProfile(j);
+					if (path.getCalls() == 0)
+						continue;
+
+					p << osc::BeginMessage(STATS_ADDRESS "/path") << node->getID() << QhullCalibrator::getPathName(j) << path.getCalls()
+						<< (float)path.getAverageMicroseconds() << (float)path.getMaxMicroseconds() << (float)path.getTotalMilliseconds() << osc::EndMessage;
+					addStatsMessage(messages, p);
+				}
+			}
+
+			if (node->getType()==OUTPUTNODE)
+			{
+				LatencyHistogram& sent = ((OscOutputEngineNode*)node)->getSendLatency();
+				int percentiles[3];
+				sent.getPercentiles(statsPercentiles, percentiles, 3);
+
+				p << osc::BeginMessage(STATS_ADDRESS "/sent") << node->getID() << (osc::int64)sent.getCount()
+					<< percentiles[0] << percentiles[1] << percentiles[2] << osc::EndMessage;
+				addStatsMessage(messages, p);
+			}
+		}
+
+		LatencyHistogram& sent = oscManager.getSendLatency();
+		int percentiles[3];
+		sent.getPercentiles(statsPercentiles, percentiles, 3);
+
+		p << osc::BeginMessage(STATS_ADDRESS "/sent") << -1 << (osc::int64)sent.getCount()
+			<< percentiles[0] << percentiles[1] << percentiles[2] << osc::EndMessage;
+		addStatsMessage(messages, p);
+	}
+
+	p << osc::BeginMessage(STATS_ADDRESS "/end") << (int)messages.size() << osc::EndMessage;
+	addStatsMessage(messages, p);
+
+	vector<vector<char> > bundles = packStatsBundles(messages);
+	for (unsigned int i=0; i<bundles.size(); i++)
+		Socket->SendTo(To, &bundles[i][0], (int)bundles[i].size());
+}
+
+void Engine::publishValues() //Called with the lock held
+{
+	if (!valueTable.isOpen())
+		return;
+
+	valueTable.beginWrite();
+
+	int entry = 0;
+	for (int i=0; i<graph.getNumberOfNodes(); i++)
+	{
+		EngineNode* node = graph.getNodeInOrder(i);
+
+		for (int j=0; j<node->getNumberOfOutputs() && entry<valueTable.getCapacity(); j++, entry++)
+		{
+			//Names are only written where the graph has changed
+			pair<int, int> output (node->getID(), j);
+			if (entry >= (int)publishedOutputs.size())
+				publishedOutputs.push_back(pair<int, int>(-1, -1));
+
+			if (publishedOutputs[entry] != output)
+			{
+				valueTable.setEntryName(entry, "node" + String(output.first) + "/" + String(j));
+				publishedOutputs[entry] = output;
+			}
+
+			valueTable.setValue(entry, node->getOutputValue(j));
+		}
+	}
+
+	publishedOutputs.resize(entry);
+	valueTable.setNumberOfEntries(entry);
+
+	valueTable.endWrite();
+}
+
+bool Engine::loadConfiguration(const XmlElement& ConfigurationElement)
+{
+	if (!ConfigurationElement.hasTagName("Configuration"))
+		return false;
+
+	const ScopedLock myScopedLock (cs);
+
+	clear();
+
+	oscManager.setBundleFrames(ConfigurationElement.getBoolAttribute("bundleFrames", true));
+	oscManager.setHonourTimeTags(ConfigurationElement.getBoolAttribute("honourTimeTags", false));
+	oscManager.setStatisticsQueries(ConfigurationElement.getBoolAttribute("statisticsQueries", false), ConfigurationElement.getStringAttribute("statisticsHosts"));
+	oscManager.setNumberOfReceiveThreads(ConfigurationElement.getIntAttribute("receiveThreads", 1));
+	oscManager.setNumberOfSocketsPerPort(ConfigurationElement.getIntAttribute("socketsPerPort", 1));
+	oscManager.setMulticastOptions(ConfigurationElement.getIntAttribute("multicastTtl", 1), ConfigurationElement.getStringAttribute("multicastInterface"));
+	setValueTable(ConfigurationElement.getStringAttribute("valueTable"));
+
+	vector<Connection> connections; //made at once after the nodes, so the order is sorted only once
+
+	forEachXmlChildElement (ConfigurationElement, e)
+	{
+		if (e->hasTagName ("Node"))
+		{
+			EngineNode* node = 0;
+
+			int type = e->getIntAttribute ("type");
+			if (type==INPUTNODE)
+				node = new OscInputEngineNode();
+			else if (type==CALIBRATORNODE)
+				node = new CalibratorEngineNode(e->getIntAttribute("numberOfInputs"), e->getIntAttribute("numberOfOutputs"));
+			else if (type==OUTPUTNODE)
+				node = new OscOutputEngineNode();
+
+			if (node)
+			{
+				node->readXml(*e);
+				addNode(node);
+
+				if (type==INPUTNODE)
+				{
+					OscInputEngineNode* inputNode = (OscInputEngineNode*)node;
+					oscManager.registerReceiver(inputNode->getAddress(), node->getNumberOfOutputs(), inputNode->getPort(), inputNode->getGroup(), inputNode->isTcp(), inputNode->getRing(), node);
+					oscManager.setQueuePolicy(node, inputNode->getQueuePolicy(), inputNode->getQueueSize());
+				}
+			}
+		}
+		else if (e->hasTagName ("Connection"))
+		{
+			Connection connection;
+			connection.outNodeId=e->getIntAttribute("outNodeId");
+			connection.outConnectorId=e->getIntAttribute("outConnectorId");
+			connection.inNodeId=e->getIntAttribute("inNodeId");
+			connection.inConnectorId=e->getIntAttribute("inConnectorId");
+
+			connections.push_back(connection);
+		}
+	}
+
+	graph.connectAll(connections);
+
+	return true;
+}
+
+void Engine::saveConfiguration(XmlElement& ConfigurationElement)
+{
+	const ScopedLock myScopedLock (cs);
+
+	ConfigurationElement.setAttribute("bundleFrames", oscManager.getBundleFrames());
+	ConfigurationElement.setAttribute("honourTimeTags", oscManager.getHonourTimeTags());
+	ConfigurationElement.setAttribute("statisticsQueries", oscManager.getStatisticsQueries());
+	if (oscManager.getStatisticsAllowedHosts().isNotEmpty())
+		ConfigurationElement.setAttribute("statisticsHosts", oscManager.getStatisticsAllowedHosts());
+	ConfigurationElement.setAttribute("receiveThreads", oscManager.getNumberOfReceiveThreads());
+	ConfigurationElement.setAttribute("socketsPerPort", oscManager.getNumberOfSocketsPerPort());
+	ConfigurationElement.setAttribute("multicastTtl", oscManager.getMulticastTtl());
+	if (oscManager.getMulticastInterface().isNotEmpty())
+		ConfigurationElement.setAttribute("multicastInterface", oscManager.getMulticastInterface());
+	if (getValueTable().isNotEmpty())
+		ConfigurationElement.setAttribute("valueTable", getValueTable());
+
+	for (int i=0; i<graph.getNumberOfNodes(); i++)
+	{
+		XmlElement* nodeElement = ConfigurationElement.createNewChildElement("Node");
+		graph.getNodeInOrder(i)->writeXml(*nodeElement);
+	}
+
+	vector<Connection> connections = graph.getConnections();
+	for (unsigned int i=0; i<connections.size(); i++)
+	{
+		XmlElement* connectionElement = ConfigurationElement.createNewChildElement("Connection");
+		connectionElement->setAttribute("inConnectorId", connections[i].inConnectorId);
+		connectionElement->setAttribute("inNodeId", connections[i].inNodeId);
+		connectionElement->setAttribute("outConnectorId", connections[i].outConnectorId);
+		connectionElement->setAttribute("outNodeId", connections[i].outNodeId);
+	}
+}
@@ -0,0 +1,125 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "NodeGraph.h"
+#include "OscManager.h"
+#include "OscInputEngineNode.h"
+#include "CalibratorEngineNode.h"
+#include "OscOutputEngineNode.h"
+#include "SharedValueTable.h"
+#include "TraceRecorder.h"
+
+#include <vector>
+using namespace std;
+
+//Reserved OSC address: a message to it on any UDP input port is never dispatched. If statistics
+//queries are enabled in the configuration and the sender is allowed (see OscManager), it is
+//answered to the sender with one message per node, calibrator path and output, and a final
+//STATS_ADDRESS "/end" message with their number, packed into bundles of up to STATS_BUNDLE_SIZE
+#define STATS_ADDRESS "/osccalibrator/stats"
+#define STATS_BUNDLE_SIZE 1400 //bytes, within the MTU of an ethernet path
+#define STATS_INTERVAL 250 //ms between answered queries, from all senders together
+
+//Receives the remote control requests coming in over OSC (e.g. the editor's active calibrator configurator)
+class EngineListener
+{
+public:
+	virtual ~EngineListener() {};
+
+	virtual void remoteAddCalibrationPoint() = 0;
+	virtual void remoteClearCalibration() = 0;
+};
+
+//The processing engine without any GUI: the node graph, the calibrators and the OSC input and output.
+//It can run a saved configuration on its own (headless mode), or serve the editor.
+class Engine
+{
+public:
+	Engine();
+	~Engine();
+
+	void start();
+	void stop();
+
+	void setListener(EngineListener* Listener) {listener=Listener;};
+	EngineListener* getListener() {return listener;};
+
+	void addNode(EngineNode* node);
+	void deleteNode(EngineNode* node);
+	void clear();
+
+	EngineNode* getNode(int Id) {return graph.getNode(Id);};
+	int getNumberOfNodes() {return graph.getNumberOfNodes();};
+	EngineNode* getNodeInOrder(int index) {return graph.getNodeInOrder(index);};
+	int getHighestID() {return graph.getHighestID();};
+
+	bool connect(const Connection& connection);
+	bool disconnectInput(int NodeId, int InputId, Connection& removed);
+	vector<Connection> disconnectOutput(int NodeId, int OutputId);
+	vector<Connection> disconnectNode(int NodeId);
+	bool isOutputConnected(int NodeId, int OutputId);
+	vector<Connection> getConnections();
+
+	void process();
+	void processExpiredJoins();
+
+	//Publishes all output values to the shared memory table of this name after every pass,
+	//as "node<id>/<output index>". An empty name stops publishing.
+	void setValueTable(const String& Name);
+	String getValueTable() {return valueTable.getName();};
+
+	//The percentiles of the latency from receiving to the evaluation of every traced node, to
+	//leaving the socket for every output, and for all outputs together. One line each.
+	String getLatencyReport();
+	//Clears the latencies and the processing profiles of all nodes and of the passes
+	void resetStatistics();
+	//The passes over the graph, each with the flush of the outputs
+	ProfileCounter& getPassProfile() {return passProfile;};
+	//Answers a STATS_ADDRESS query:
+	//  /node <id> <type> <calls> <avg us> <max us> <total ms> <latency p50 us> <p99> <p999>
+	//  /path <calibrator id> <path name> <calls> <avg us> <max us> <total ms>
+	//  /sent <output id, -1 for all> <count, int64> <latency p50 us> <p99> <p999>
+	void sendStatistics(UdpSocket* Socket, const IpEndpointName& To);
+
+	//Configuration XML as written by the editor. Nodes are created with the ids stored in the file.
+	bool loadConfiguration(const XmlElement& ConfigurationElement);
+	void saveConfiguration(XmlElement& ConfigurationElement);
+
+	//Held while the graph is processed or changed
+	CriticalSection& getLock() {return cs;};
+
+	OscManager oscManager;
+
+	//Records Chrome trace event JSON of the processing stages for a while
+	TraceRecorder& getTraceRecorder() {return traceRecorder;};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	OutputClock outputClock; //sends the outputs with their own schedule
+	NodeGraph graph;
+	EngineListener* listener;
+	TraceRecorder traceRecorder;
+	ProfileCounter passProfile;
+
+	SharedValueTable valueTable;
+	vector<pair<int, int> > publishedOutputs; //node id and output index of each table entry
+
+	void publishValues();
+
+	CriticalSection cs;
+};
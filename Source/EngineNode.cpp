@@ -0,0 +1,93 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "EngineNode.h"
+
+EngineNode::EngineNode()
+{
+	id = -1;
+	type = -1; //unspecified
+	updated = false;
+	receiveTicks = 0;
+	joinPolicy = JOIN_NONE;
+	joinTimeout = 50;
+}
+
+EngineNode::~EngineNode()
+{
+}
+
+void EngineNode::setNumberOfInputs(int NumberOfInputs)
+{
+	inputValues.resize(NumberOfInputs, 0);
+}
+
+void EngineNode::setNumberOfOutputs(int NumberOfOutputs)
+{
+	outputValues.resize(NumberOfOutputs, 0);
+}
+
+float EngineNode::getInputValue(int ConnectorIndex)
+{
+	if (ConnectorIndex>=0 && ConnectorIndex < (int)inputValues.size())
+		return inputValues[ConnectorIndex];
+	else return 0;
+}
+
+float EngineNode::getOutputValue(int ConnectorIndex)
+{
+	if (ConnectorIndex>=0 && ConnectorIndex < (int)outputValues.size())
+		return outputValues[ConnectorIndex];
+	else return 0;
+}
+
+void EngineNode::setInputValue(int ConnectorIndex, float Value)
+{
+	if (ConnectorIndex>=0 && ConnectorIndex < (int)inputValues.size())
+		inputValues[ConnectorIndex]=Value;
+}
+
+void EngineNode::setOutputValue(int ConnectorIndex, float Value)
+{
+	if (ConnectorIndex>=0 && ConnectorIndex < (int)outputValues.size())
+		outputValues[ConnectorIndex]=Value;
+}
+
+void EngineNode::process()
+{
+}
+
+bool EngineNode::takeUpdate() //True if the node has been updated from outside the graph since the last processing pass
+{
+	bool result = updated;
+	updated = false;
+	return result;
+}
+
+void EngineNode::resetStatistics()
+{
+	latency.reset();
+	processProfile.reset();
+}
+
+void EngineNode::readXml(const XmlElement& NodeElement)
+{
+	id = NodeElement.getIntAttribute("id");
+}
+
+void EngineNode::writeXml(XmlElement& NodeElement)
+{
+	NodeElement.setAttribute("type", type);
+	NodeElement.setAttribute("id", id);
+}
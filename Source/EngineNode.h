@@ -0,0 +1,96 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "LatencyHistogram.h"
+#include "ProfileCounter.h"
+
+#include <vector>
+using namespace std;
+
+#define INPUTNODE 0
+#define CALIBRATORNODE 1
+#define OUTPUTNODE 2
+
+#define JOIN_NONE 0 //evaluate whenever one of the inputs has been updated
+#define JOIN_ALL 1 //evaluate once all connected inputs have been updated (or the join timeout has passed)
+
+//The processing part of a node: its values and its process function, without any GUI.
+class EngineNode
+{
+public:
+	EngineNode();
+	virtual ~EngineNode();
+
+	int getID() {return id;};
+	void setID(int Id) {id=Id;};
+	int getType() {return type;};
+
+	int getNumberOfInputs() {return (int)inputValues.size();};
+	int getNumberOfOutputs() {return (int)outputValues.size();};
+	void setNumberOfInputs(int NumberOfInputs);
+	void setNumberOfOutputs(int NumberOfOutputs);
+
+	float getInputValue(int ConnectorIndex);
+	float getOutputValue(int ConnectorIndex);
+	void setInputValue(int ConnectorIndex, float Value);
+	void setOutputValue(int ConnectorIndex, float Value);
+	float* getOutputValues() {return outputValues.empty() ? 0 : &outputValues[0];}; //all outputs as one block, for decoding into
+
+	virtual void process();
+
+	void markUpdated() {updated=true;};
+	virtual bool takeUpdate();
+
+	//When the oldest received value behind the current values arrived (Time::getHighResolutionTicks),
+	//0 if there is none. Set by the receivers for input nodes and by the graph for the others.
+	int64 getReceiveTicks() {return receiveTicks;};
+	void setReceiveTicks(int64 Ticks) {receiveTicks=Ticks;};
+	//From receiving to the end of the evaluation of the node
+	LatencyHistogram& getLatency() {return latency;};
+	//The calls of process by the graph
+	ProfileCounter& getProcessProfile() {return processProfile;};
+	//Clears the latencies and profiles
+	virtual void resetStatistics();
+
+	bool isJoining() {return joinPolicy==JOIN_ALL;};
+	int getJoinPolicy() {return joinPolicy;};
+	void setJoinPolicy(int JoinPolicy) {joinPolicy=JoinPolicy;};
+	int getJoinTimeout() {return joinTimeout;};
+	void setJoinTimeout(int JoinTimeout) {joinTimeout=JoinTimeout;};
+
+	//Configuration XML: the node specific attributes and child elements of a "Node" element
+	virtual void readXml(const XmlElement& NodeElement);
+	virtual void writeXml(XmlElement& NodeElement);
+
+	juce_UseDebuggingNewOperator
+
+protected:
+	int id;
+	int type;
+	vector<float> inputValues;
+	vector<float> outputValues;
+	bool updated; //new values from outside the graph (received messages, configurator changes)
+	int64 receiveTicks;
+	LatencyHistogram latency;
+	ProfileCounter processProfile;
+	int joinPolicy;
+	int joinTimeout; //ms, 0 means no timeout
+
+private:
+	EngineNode (const EngineNode&);
+	const EngineNode& operator= (const EngineNode&);
+};
@@ -37,7 +37,6 @@ InputConnector::InputConnector ()
 	id=-1;
 	isConnected=false;
 	dragInside=false;
-	value=0;
 }
 
 InputConnector::~InputConnector()
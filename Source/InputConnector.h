@@ -44,9 +44,6 @@ public:
 	void setConnected(bool IsConnected);
 	bool isItConnected() {return isConnected;};
 
-	float getValue() {return value;};
-	void setValue(float Value) {value=Value;};
-
 	String getLabel() {return label->getText();};
 	void setLabel(String text) {label->setText(text, true);};
 
@@ -62,7 +59,6 @@ private:
 	int id;
 	bool isConnected;
 	bool dragInside;
-	float value;
 
     //==============================================================================
     // (prevent copy constructor and operator= being generated..)
@@ -0,0 +1,164 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::record(int Microseconds)
+{
+	if (Microseconds < 0)
+		Microseconds = 0;
+
+	const int bucket = getBucket(Microseconds);
+	buckets[bucket] = buckets[bucket] + 1;
+	count = count + 1;
+
+	if (Microseconds > max)
+		max = Microseconds;
+}
+
+void LatencyHistogram::recordSince(int64 Ticks, int64 Now)
+{
+	if (Ticks == 0)
+		return;
+
+	record((int)jmin(ticksToMicroseconds(Now - Ticks), (int64)0x7fffffff));
+}
+
+int LatencyHistogram::getPercentile(double Fraction)
+{
+	//Counters keep changing while they are read, so the total is taken from the buckets
+	int64 total = 0;
+	for (int i=0; i<LATENCY_BUCKETS; i++)
+		total += buckets[i];
+
+	if (total == 0)
+		return 0;
+
+	int64 rank = jmax((int64)1, (int64)ceil(Fraction * total));
+	int64 seen = 0;
+
+	for (int i=0; i<LATENCY_BUCKETS; i++)
+	{
+		seen += buckets[i];
+
+		if (seen >= rank)
+			return jmin(getBucketLimit(i), (int)max);
+	}
+
+	return max;
+}
+
+void LatencyHistogram::getPercentiles(const double* Fractions, int* Results, int Count)
+{
+	int64 total = 0;
+	for (int i=0; i<LATENCY_BUCKETS; i++)
+		total += buckets[i];
+
+	int64 seen = 0;
+	int bucket = 0;
+
+	for (int j=0; j<Count; j++)
+	{
+		if (total == 0)
+		{
+			Results[j] = 0;
+			continue;
+		}
+
+		int64 rank = jmax((int64)1, (int64)ceil(Fractions[j] * total));
+
+		for (; bucket < LATENCY_BUCKETS; bucket++)
+		{
+			int64 n = buckets[bucket];
+			if (seen + n >= rank)
+				break;
+
+			seen += n;
+		}
+
+		Results[j] = bucket < LATENCY_BUCKETS ? jmin(getBucketLimit(bucket), (int)max) : max;
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	for (int i=0; i<LATENCY_BUCKETS; i++)
+		buckets[i] = 0;
+
+	count = 0;
+	max = 0;
+}
+
+static String formatMicroseconds(int Microseconds)
+{
+	if (Microseconds < 1000)
+		return String(Microseconds) + " us";
+	else if (Microseconds < 1000000)
+		return String(Microseconds / 1000.0, 1) + " ms";
+	else
+		return String(Microseconds / 1000000.0, 2) + " s";
+}
+
+String LatencyHistogram::getSummary()
+{
+	return "p50 " + formatMicroseconds(getPercentile(0.5))
+		+ ", p99 " + formatMicroseconds(getPercentile(0.99))
+		+ ", p999 " + formatMicroseconds(getPercentile(0.999))
+		+ " (n " + String(getCount()) + ")";
+}
+
+int64 LatencyHistogram::ticksToMicroseconds(int64 Ticks)
+{
+	static const int64 ticksPerSecond = Time::getHighResolutionTicksPerSecond();
+
+	//Split, so that the multiplication can't overflow
+	return (Ticks / ticksPerSecond) * 1000000 + (Ticks % ticksPerSecond) * 1000000 / ticksPerSecond;
+}
+
+int64 LatencyHistogram::microsecondsToTicks(int64 Microseconds)
+{
+	static const int64 ticksPerSecond = Time::getHighResolutionTicksPerSecond();
+
+	return (Microseconds / 1000000) * ticksPerSecond + (Microseconds % 1000000) * ticksPerSecond / 1000000;
+}
+
+//Values below 2*LATENCY_SUB_BUCKETS have a bucket each; above, every power of two is split
+//into LATENCY_SUB_BUCKETS buckets
+int LatencyHistogram::getBucket(int Microseconds)
+{
+	if (Microseconds < 2 * LATENCY_SUB_BUCKETS)
+		return Microseconds;
+
+	int shift = 0;
+	while ((Microseconds >> shift) >= 2 * LATENCY_SUB_BUCKETS)
+		shift++;
+
+	return LATENCY_SUB_BUCKETS + shift * LATENCY_SUB_BUCKETS + (Microseconds >> shift);
+}
+
+int LatencyHistogram::getBucketLimit(int Bucket)
+{
+	if (Bucket < 2 * LATENCY_SUB_BUCKETS)
+		return Bucket;
+
+	int shift = (Bucket - LATENCY_SUB_BUCKETS) / LATENCY_SUB_BUCKETS - 1;
+	int value = Bucket - LATENCY_SUB_BUCKETS - shift * LATENCY_SUB_BUCKETS;
+
+	return (int)jmin(((int64)(value + 1) << shift) - 1, (int64)0x7fffffff);
+}
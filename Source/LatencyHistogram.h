@@ -0,0 +1,61 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+#define LATENCY_SUB_BUCKETS 16 //per power of two, so values are kept within 1/16 (6%)
+#define LATENCY_BUCKETS (29 * LATENCY_SUB_BUCKETS) //0 to 2^31 microseconds
+
+//A histogram of latencies in microseconds with logarithmic buckets, like an HDR histogram.
+//Recorded to by one thread at a time, with the engine lock held; other threads may read the
+//percentiles without a lock and get a slightly stale value. The counters are 64 bit, so they
+//don't wrap however long the engine runs.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void record(int Microseconds);
+	//Records the time since Ticks, a Time::getHighResolutionTicks value; ignored if Ticks is 0
+	void recordSince(int64 Ticks, int64 Now);
+
+	//The latency below which this fraction (0 to 1) of the recorded ones are, 0 if none
+	int getPercentile(double Fraction);
+	//Several at once with a single pass over the buckets, Fractions in ascending order
+	void getPercentiles(const double* Fractions, int* Results, int Count);
+	int64 getCount() {return count;};
+	int getMax() {return max;};
+	void reset();
+
+	//"p50 120 us, p99 480 us, p999 1.2 ms (n 5000)"
+	String getSummary();
+
+	static int64 ticksToMicroseconds(int64 Ticks);
+	static int64 microsecondsToTicks(int64 Microseconds);
+
+	juce_UseDebuggingNewOperator
+
+private:
+	volatile int64 buckets[LATENCY_BUCKETS];
+	volatile int64 count;
+	volatile int max;
+
+	static int getBucket(int Microseconds);
+	static int getBucketLimit(int Bucket); //the highest value of the bucket
+
+	LatencyHistogram (const LatencyHistogram&);
+	const LatencyHistogram& operator= (const LatencyHistogram&);
+};
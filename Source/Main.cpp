@@ -14,6 +14,8 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MainComponent.h"
 #include "Pool.h"
+#include "PacketCapture.h"
+#include "Benchmark.h"
 
 class MainWindow  : public DocumentWindow
 {
@@ -39,7 +41,7 @@ public:
     //==============================================================================
     void closeButtonPressed()
     {
-		((MainComponent*)getContentComponent())->oscManager.stop();
+		((MainComponent*)getContentComponent())->engine.stop();
         JUCEApplication::quit();
     }
 };
@@ -49,7 +51,7 @@ class OscCalibratorApplication  : public JUCEApplication
 {
 public:
     //==============================================================================
-    OscCalibratorApplication() : mainWindow(0)
+    OscCalibratorApplication() : mainWindow(0), engine(0)
     {
     }
 
@@ -69,13 +71,193 @@ public:
 		#endif
 		*/
 
+		StringArray arguments;
+		arguments.addTokens(commandLine, true);
+
+		//Replay mode: "--replay <capture> [--speed <factor>|max] [--host <host>]" sends a capture made
+		//with --capture to the ports it was recorded on, then quits
+		int replayIndex = arguments.indexOf("--replay");
+		if (replayIndex != -1)
+		{
+			if (!replay(arguments, replayIndex))
+				setApplicationReturnValue(1);
+
+			quit();
+			return;
+		}
+
+		//Test mode: "--test" runs the unit tests, then quits
+		if (arguments.contains("--test"))
+		{
+			if (!runTests())
+				setApplicationReturnValue(1);
+
+			quit();
+			return;
+		}
+
+		//"--capture <file>" records the received datagrams for replaying them later
+		int captureIndex = arguments.indexOf("--capture");
+		String capturePath = captureIndex != -1 ? arguments[captureIndex+1].unquoted() : String::empty;
+
+		//"--trace <file> [--trace-seconds <seconds>]" records Chrome trace event JSON of the
+		//processing stages, for 10 seconds by default
+		int traceIndex = arguments.indexOf("--trace");
+		String tracePath = traceIndex != -1 ? arguments[traceIndex+1].unquoted() : String::empty;
+
+		int traceSecondsIndex = arguments.indexOf("--trace-seconds");
+		double traceSeconds = traceSecondsIndex != -1 ? arguments[traceSecondsIndex+1].getDoubleValue() : 10;
+
+		//Benchmark mode: "--benchmark <configuration.xml>" runs a saved configuration under synthetic load
+		//and reports the throughput, CPU and latency, then quits (see BenchmarkSettings for the options)
+		int benchmarkIndex = arguments.indexOf("--benchmark");
+		if (benchmarkIndex != -1)
+		{
+			BenchmarkSettings settings;
+			settings.parse(arguments);
+
+			if (!startHeadless(arguments[benchmarkIndex+1].unquoted()) || !startTrace(engine, tracePath, traceSeconds))
+				setApplicationReturnValue(1);
+			else
+			{
+				Thread::sleep(500); //for the receiving sockets to be opened
+				if (!runBenchmark(engine, settings))
+					setApplicationReturnValue(1);
+			}
+
+			quit();
+			return;
+		}
+
+		//Headless mode: "--headless <configuration.xml>" runs a saved configuration without any editor
+		int headlessIndex = arguments.indexOf("--headless");
+		if (headlessIndex != -1)
+		{
+			if (!startHeadless(arguments[headlessIndex+1].unquoted()) || !startCapture(engine, capturePath)
+				|| !startTrace(engine, tracePath, traceSeconds))
+			{
+				setApplicationReturnValue(1);
+				quit();
+			}
+
+			return;
+		}
+
         mainWindow = new MainWindow();
+		startCapture(&((MainComponent*)mainWindow->getContentComponent())->engine, capturePath);
+		startTrace(&((MainComponent*)mainWindow->getContentComponent())->engine, tracePath, traceSeconds);
     }
 
+	bool runTests()
+	{
+		UnitTestRunner runner;
+		runner.runAllTests(false);
+
+		int failures = 0;
+		for (int i=0; i<runner.getNumResults(); i++)
+			failures += runner.getResult(i)->failures;
+
+		Logger::writeToLog("OscCalibrator: " + String(failures) + " of the unit tests failed");
+		return failures == 0;
+	}
+
+	bool startTrace(Engine* theEngine, const String& TracePath, double Seconds)
+	{
+		if (TracePath.isEmpty())
+			return true;
+
+		File traceFile (File::getCurrentWorkingDirectory().getChildFile(TracePath));
+		if (!theEngine->getTraceRecorder().start(traceFile, Seconds))
+		{
+			Logger::writeToLog("OscCalibrator: unable to write the trace " + traceFile.getFullPathName());
+			return false;
+		}
+
+		Logger::writeToLog("OscCalibrator: tracing for " + String(Seconds) + " s to " + traceFile.getFullPathName());
+		return true;
+	}
+
+	bool startCapture(Engine* theEngine, const String& CapturePath)
+	{
+		if (CapturePath.isEmpty())
+			return true;
+
+		File captureFile (File::getCurrentWorkingDirectory().getChildFile(CapturePath));
+		if (!theEngine->oscManager.getCapture().start(captureFile))
+		{
+			Logger::writeToLog("OscCalibrator: unable to write the capture " + captureFile.getFullPathName());
+			return false;
+		}
+
+		Logger::writeToLog("OscCalibrator: capturing to " + captureFile.getFullPathName());
+		return true;
+	}
+
+	bool replay(const StringArray& Arguments, int ReplayIndex)
+	{
+		File captureFile (File::getCurrentWorkingDirectory().getChildFile(Arguments[ReplayIndex+1].unquoted()));
+
+		double speed = 1;
+		int speedIndex = Arguments.indexOf("--speed");
+		if (speedIndex != -1)
+			speed = Arguments[speedIndex+1] == "max" ? 0 : jmax(0.0, Arguments[speedIndex+1].getDoubleValue());
+
+		String host = "127.0.0.1";
+		int hostIndex = Arguments.indexOf("--host");
+		if (hostIndex != -1)
+			host = Arguments[hostIndex+1].unquoted();
+
+		double start = Time::getMillisecondCounterHiRes();
+		int count = replayCapture(captureFile, host, speed);
+		if (count < 0)
+		{
+			Logger::writeToLog("OscCalibrator: not a capture file: " + captureFile.getFullPathName());
+			return false;
+		}
+
+		double seconds = (Time::getMillisecondCounterHiRes() - start) / 1000.0;
+		Logger::writeToLog("OscCalibrator: replayed " + String(count) + " datagrams to " + host + " in "
+			+ String(seconds, 3) + " s (" + String(seconds > 0 ? count / seconds : 0.0, 0) + " per second)");
+		return true;
+	}
+
+	bool startHeadless(const String& ConfigurationPath)
+	{
+		File configurationFile (File::getCurrentWorkingDirectory().getChildFile(ConfigurationPath));
+		if (ConfigurationPath.isEmpty() || !configurationFile.existsAsFile())
+		{
+			Logger::writeToLog("OscCalibrator: configuration file not found: " + ConfigurationPath);
+			return false;
+		}
+
+		XmlDocument configurationDocument(configurationFile);
+		ScopedPointer<XmlElement> configurationElement (configurationDocument.getDocumentElement());
+		if (configurationElement == 0)
+		{
+			Logger::writeToLog("OscCalibrator: " + configurationDocument.getLastParseError());
+			return false;
+		}
+
+		engine = new Engine();
+		if (!engine->loadConfiguration(*configurationElement))
+		{
+			Logger::writeToLog("OscCalibrator: not a configuration file: " + configurationFile.getFullPathName());
+			engine = 0;
+			return false;
+		}
+
+		engine->start();
+		return true;
+	}
+
     void shutdown()
     {
         mainWindow = 0;
 
+		if (engine != 0)
+			engine->stop();
+		engine = 0;
+
 		int curlong, totlong;
 		qh_memfreeshort (&curlong, &totlong);  /* free short memory and memory allocator */
     }
@@ -109,6 +291,7 @@ public:
 
 private:
     ScopedPointer<MainWindow> mainWindow;
+	ScopedPointer<Engine> engine; //headless mode only
 
 };
 
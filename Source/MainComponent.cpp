@@ -22,8 +22,8 @@ MainComponent::MainComponent(void)
 	addKeyListener(this);
 	runningNodeID = -1;
 
-	oscManager.setMainComponent(this);
-	oscManager.startThread();
+	engine.setListener(this);
+	engine.start();
 
 	activeConfigurator = 0; 
 }
@@ -31,12 +31,18 @@ MainComponent::MainComponent(void)
 
 MainComponent::~MainComponent(void)
 {
-	for (unsigned int i=0; i<nodes.size(); i++)
+	engine.stop();
+
+	for (unordered_map<int, Node*>::iterator it=nodes.begin(); it!=nodes.end(); it++)
 	{
-		delete nodes[i];
+		delete it->second;
 	}
+	nodes.clear();
+}
 
-	oscManager.stop();
+void MainComponent::timerCallback()
+{
+	repaint();
 }
 
 void MainComponent::paint (Graphics& g)
@@ -44,6 +50,7 @@ void MainComponent::paint (Graphics& g)
 	g.fillAll (Colours::lightgrey);
 
 	//Draw connections
+	vector<Connection> connections = engine.getConnections();
 	for (unsigned int i=0; i<connections.size(); i++)
 	{
 		Node* startNode=getNode(connections[i].outNodeId);
@@ -78,6 +85,15 @@ void MainComponent::mouseUp(const MouseEvent &e)
 
 		m.addSeparator();
 
+		m.addItem (7, "Process OSC bundles as frames", true, engine.oscManager.getBundleFrames());
+		m.addItem (8, "Honour bundle time tags", engine.oscManager.getBundleFrames(), engine.oscManager.getHonourTimeTags());
+		m.addItem (9, "Capture incoming packets...", true, engine.oscManager.getCapture().isCapturing());
+		m.addItem (10, "Latency...");
+		m.addItem (11, "Show processing statistics", true, Node::isShowingStatistics());
+		m.addItem (12, engine.getTraceRecorder().isBusy() ? "Stop recording trace" : "Record trace (10 s)...");
+
+		m.addSeparator();
+
 		m.addItem (6, "About...");
 
         const int result = m.show();
@@ -90,14 +106,15 @@ void MainComponent::mouseUp(const MouseEvent &e)
         {
             // user picked item 1
 			OscInputNode* node;
-			node = new OscInputNode();
+			node = new OscInputNode(new OscInputEngineNode());
 			runningNodeID++;
 			node->setID(runningNodeID);
-			node->setOscManager(&oscManager);
+			node->setOscManager(&engine.oscManager);
 			node->addMouseListener(this, true);
 			addAndMakeVisible(node);
 			node->setTopLeftPosition(e.getPosition().getX(), e.getPosition().getY());
-			nodes.push_back(node);
+
+			addNode(node);
         }
         else if (result == 2)
         {
@@ -110,14 +127,14 @@ void MainComponent::mouseUp(const MouseEvent &e)
 
 			if (result)
 			{
-				CalibratorNode* node = new CalibratorNode();
-				node->initialise(calibratorInitializer->getNumberOfInputs(), calibratorInitializer->getNumberOfOutputs());
+				CalibratorNode* node = new CalibratorNode(new CalibratorEngineNode(calibratorInitializer->getNumberOfInputs(), calibratorInitializer->getNumberOfOutputs()));
 				runningNodeID++;
 				node->setID(runningNodeID);
 				node->addMouseListener(this, true);
 				addAndMakeVisible(node);
 				node->setTopLeftPosition(e.getPosition().getX(), e.getPosition().getY());
-				nodes.push_back(node);
+
+				addNode(node);
 			}
 
 			delete temp;
@@ -127,13 +144,14 @@ void MainComponent::mouseUp(const MouseEvent &e)
         {
             // user picked item 3
 			OscOutputNode* node;
-			node = new OscOutputNode();
+			node = new OscOutputNode(new OscOutputEngineNode());
 			runningNodeID++;
 			node->setID(runningNodeID);
 			node->addMouseListener(this, true);
 			addAndMakeVisible(node);
 			node->setTopLeftPosition(e.getPosition().getX(), e.getPosition().getY());
-			nodes.push_back(node);
+
+			addNode(node);
         }
 		else if (result == 4)
         {
@@ -150,6 +168,38 @@ void MainComponent::mouseUp(const MouseEvent &e)
 
 			delete aboutComponent;
 		}
+		else if (result == 7)
+		{
+			engine.oscManager.setBundleFrames(!engine.oscManager.getBundleFrames());
+		}
+		else if (result == 8)
+		{
+			engine.oscManager.setHonourTimeTags(!engine.oscManager.getHonourTimeTags());
+		}
+		else if (result == 9)
+		{
+			toggleCapture();
+		}
+		else if (result == 10)
+		{
+			if (AlertWindow::showOkCancelBox(AlertWindow::InfoIcon, "Latency", engine.getLatencyReport(), "Reset", "Close"))
+				engine.resetStatistics();
+		}
+		else if (result == 11)
+		{
+			Node::setShowStatistics(!Node::isShowingStatistics());
+
+			if (Node::isShowingStatistics())
+				startTimer(500);
+			else
+				stopTimer();
+
+			repaint();
+		}
+		else if (result == 12)
+		{
+			toggleTrace();
+		}
 	}
 }
 
@@ -160,123 +210,71 @@ void MainComponent::mouseDrag(const MouseEvent &e)
 
 bool MainComponent::connect(int outNodeId, int outConnectorId, int inNodeId, int inConnectorId)
 {
-	//Check for loops
-	if (outNodeId == inNodeId)
-		return false;
-	else if (getNode(outNodeId)->processingPriority > getNode(inNodeId)->processingPriority && getNode(outNodeId)->processingPriority && getNode(inNodeId)->processingPriority)
-		return false;
-
-	//Check if inConnector already connected
-	for (unsigned int i=0; i<connections.size(); i++)
-		if (connections[i].inNodeId==inNodeId && connections[i].inConnectorId==inConnectorId)
-			return false;
-	
 	Connection connection;
 	connection.outNodeId=outNodeId;
 	connection.outConnectorId=outConnectorId;
 	connection.inNodeId=inNodeId;
 	connection.inConnectorId=inConnectorId;
 
-	connections.push_back(connection);
+	//Rejects loops and already connected inputs
+	if (!engine.connect(connection))
+		return false;
 
 	getNode(outNodeId)->setConnectivityOfOutput(outConnectorId, true);
 	getNode(inNodeId)->setConnectivityOfInput(inConnectorId, true);
 
-	sortNodes();
 	repaint();
 
 	return true;
 }
 
-Node* MainComponent::getNode(int Id)
+void MainComponent::disconnectInput(int NodeId, int InputId)
 {
-	Node* result=0;
+	Connection removed;
+	if (engine.disconnectInput(NodeId, InputId, removed))
+		releaseConnectors(vector<Connection>(1, removed));
 
-	for (unsigned int i=0; i<nodes.size(); i++)
-		if (nodes[i]->getID()==Id)
-			result=nodes[i];
-
-	return result;
+	repaint();
 }
 
-void MainComponent::disconnectInput(int NodeId, int InputId)
+void MainComponent::disconnectOutput(int NodeId, int OutputId)
 {
-	unsigned int i=0;
-	int tempOutNode=-1;
-	int tempOutConnector=-1;
-
-	while (i<connections.size())
-	{
-		if (connections[i].inNodeId==NodeId && connections[i].inConnectorId==InputId)
-		{
-			getNode(connections[i].inNodeId)->setConnectivityOfInput(connections[i].inConnectorId, false);
-
-			tempOutNode=connections[i].outNodeId;
-			tempOutConnector=connections[i].outConnectorId;
-
-			connections.erase(connections.begin()+i);
-		}
+	releaseConnectors(engine.disconnectOutput(NodeId, OutputId));
 
-		i++;
-	}
-
-
-	if (tempOutNode!=-1 && tempOutConnector!=-1)
-	{
-		bool found=false;
-
-		i=0;
-		while (i<connections.size())
-		{
-			if (connections[i].outNodeId==tempOutNode && connections[i].outConnectorId==tempOutConnector)
-				found=true;
+	Node* node = getNode(NodeId);
+	if (node)
+		node->setConnectivityOfOutput(OutputId, false);
 
-			i++;
-		}
-
-		if (!found)
-			getNode(tempOutNode)->setConnectivityOfOutput(tempOutConnector, false);
-	}
-
-//	sortNodes();
 	repaint();
 }
 
-void MainComponent::disconnectOutput(int NodeId, int OutputId)
+void MainComponent::releaseConnectors(const vector<Connection>& removed)
 {
-	int i=0;
-
-	while (i<(int)connections.size())
+	for (unsigned int i=0; i<removed.size(); i++)
 	{
-		if (connections[i].outNodeId==NodeId && connections[i].outConnectorId==OutputId)
-		{
-			disconnectInput(connections[i].inNodeId, connections[i].inConnectorId);
-			i=-1;
-		}
-		i++;
+		Node* inNode = getNode(removed[i].inNodeId);
+		if (inNode)
+			inNode->setConnectivityOfInput(removed[i].inConnectorId, false);
 
-		getNode(NodeId)->setConnectivityOfOutput(OutputId, false);
+		Node* outNode = getNode(removed[i].outNodeId);
+		if (outNode && !engine.isOutputConnected(removed[i].outNodeId, removed[i].outConnectorId))
+			outNode->setConnectivityOfOutput(removed[i].outConnectorId, false);
 	}
-
-//	sortNodes();
-	repaint();
 }
 
 bool MainComponent::keyPressed (const KeyPress & key, Component* originatingComponent)
 {
 	if (key.getKeyCode()==KeyPress::deleteKey)
 	{
-		const ScopedLock myScopedLock (cs);
-
-		int selectedNodeIndex=-1;
-		for (unsigned int i=0; i<nodes.size(); i++)
+		Node* selectedNode=0;
+		for (unordered_map<int, Node*>::iterator it=nodes.begin(); it!=nodes.end(); it++)
 		{
-			if (nodes[i]->isSelected())
-				selectedNodeIndex=(int)i;
+			if (it->second->isSelected())
+				selectedNode=it->second;
 		}
 
-		if (selectedNodeIndex!=-1)
-			deleteNode(nodes[selectedNodeIndex]);
+		if (selectedNode)
+			deleteNode(selectedNode);
 	}
 
 	return true;
@@ -286,18 +284,18 @@ void MainComponent::mouseDown (const MouseEvent &e)
 {
 	if (e.mods.isLeftButtonDown() && e.eventComponent==this)
 	{
-		for (unsigned int i=0; i<nodes.size(); i++)
+		for (unordered_map<int, Node*>::iterator it=nodes.begin(); it!=nodes.end(); it++)
 		{
-			if (nodes[i]->isSelected())
-				nodes[i]->setSelected(false);
+			if (it->second->isSelected())
+				it->second->setSelected(false);
 		}
 	}
 	else if (e.mods.isLeftButtonDown() && isParentOf(e.eventComponent))
 	{
-		for (unsigned int i=0; i<nodes.size(); i++)
+		for (unordered_map<int, Node*>::iterator it=nodes.begin(); it!=nodes.end(); it++)
 		{
-			if (nodes[i]->isSelected())
-				nodes[i]->setSelected(false);
+			if (it->second->isSelected())
+				it->second->setSelected(false);
 		}
 
 		if (getIndexOfChildComponent(e.eventComponent)!=-1)
@@ -307,123 +305,73 @@ void MainComponent::mouseDown (const MouseEvent &e)
 	}
 }
 
-void MainComponent::deleteNode(Node* node)
+Node* MainComponent::getNode(int Id)
 {
-	int nodeIndex=-1;
-	for (unsigned int i=0; i<nodes.size(); i++)
-	{
-		if (nodes[i]==node)
-			nodeIndex=(int)i;
-	}
+	unordered_map<int, Node*>::iterator it = nodes.find(Id);
 
-	if (nodeIndex!=-1)
-	{
-		for (int i=0; i<nodes[nodeIndex]->getNumberOfInputs(); i++)
-		{
-			disconnectInput(nodes[nodeIndex]->getID(), i);
-		}
-
-		for (int i=0; i<nodes[nodeIndex]->getNumberOfOutputs(); i++)
-		{
-			disconnectOutput(nodes[nodeIndex]->getID(), i);
-		}
+	if (it != nodes.end())
+		return it->second;
+	else
+		return 0;
+}
 
-		oscManager.unregisterReceiver(nodes[nodeIndex]);
-		removeChildComponent(nodes[nodeIndex]);
-		delete nodes[nodeIndex];
-		nodes.erase(nodes.begin()+nodeIndex);
-	}
+void MainComponent::addNode(Node* node)
+{
+	nodes[node->getID()] = node;
+	engine.addNode(node->getEngineNode());
 }
 
-void MainComponent::deleteConnectionsOfNode(Node* node)
+void MainComponent::deleteNode(Node* node)
 {
-	int nodeIndex=-1;
-	for (unsigned int i=0; i<nodes.size(); i++)
+	if (getNode(node->getID())==node)
 	{
-		if (nodes[i]==node)
-			nodeIndex=(int)i;
-	}
+		deleteConnectionsOfNode(node);
 
-	if (nodeIndex!=-1)
-	{
-		for (int i=0; i<nodes[nodeIndex]->getNumberOfInputs(); i++)
-		{
-			disconnectInput(nodes[nodeIndex]->getID(), i);
-		}
+		EngineNode* engineNode = node->getEngineNode();
 
-		for (int i=0; i<nodes[nodeIndex]->getNumberOfOutputs(); i++)
-		{
-			disconnectOutput(nodes[nodeIndex]->getID(), i);
-		}
+		nodes.erase(node->getID());
+		removeChildComponent(node);
+		delete node;
+
+		engine.deleteNode(engineNode);
 	}
 }
 
-void MainComponent::sortNodes()
+void MainComponent::deleteConnectionsOfNode(Node* node)
 {
-	int currentPriority = 1;
-	unsigned int processedNodes=0;
-
-	//Reset and assign the highest priority (1) to the nodes without connected inputs, and the priority of 0 for the unconnected nodes
-	for (unsigned int i=0; i<nodes.size(); i++)
-	{
-		nodes[i]->processingPriority=numeric_limits<int>::max();
-
-		if (!nodes[i]->isAnInputConnected() && !nodes[i]->isAnOutputConnected())
-		{
-			nodes[i]->processingPriority=0;
-			processedNodes++;
-		}
-		else if (!nodes[i]->isAnInputConnected())
-		{
-			nodes[i]->processingPriority=currentPriority;
-			processedNodes++;
-		}
-	}
+	releaseConnectors(engine.disconnectNode(node->getID()));
+}
 
-	//Derive the priorities from the connections, until we have processed all nodes
-	while (processedNodes!=nodes.size() && currentPriority<(int)nodes.size())
+void MainComponent::clearConfiguration()
+{
+	for (unordered_map<int, Node*>::iterator it=nodes.begin(); it!=nodes.end(); it++)
 	{
-		for (unsigned int i=0; i<connections.size(); i++)
-		{
-			if (getNode(connections[i].outNodeId)->processingPriority==currentPriority)
-			{
-				getNode(connections[i].inNodeId)->processingPriority=currentPriority+1;
-				processedNodes++;
-			}
-		}
-		currentPriority++;
+		removeChildComponent(it->second);
+		delete it->second;
 	}
+	nodes.clear();
 
-	sort(nodes.begin(), nodes.end(), &MainComponent::nodeSortPredicate);
+	engine.clear();
 }
 
-bool MainComponent::nodeSortPredicate(const Node* a, const Node* b)
+void MainComponent::remoteAddCalibrationPoint()
 {
-	return a->processingPriority < b->processingPriority;
+	const MessageManagerLock mmLock;
+
+	if (activeConfigurator)
+		activeConfigurator->buttonClicked(activeConfigurator->addButton);
 }
 
-void MainComponent::process() //Propagates the data over the connections and calls the process function of the nodes
+void MainComponent::remoteClearCalibration()
 {
-	const ScopedLock myScopedLock (cs);
-
-	for (unsigned int i=0; i<nodes.size(); i++)
-	{
-		for (unsigned int j=0; j<connections.size(); j++)
-		{
-			if (connections[j].inNodeId==nodes[i]->getID())
-			{
-				nodes[i]->setInputValue(connections[j].inConnectorId, getNode(connections[j].outNodeId)->getOutputValue(connections[j].outConnectorId));
-			}
-		}
+	const MessageManagerLock mmLock;
 
-		nodes[i]->process();
-	}
+	if (activeConfigurator)
+		activeConfigurator->buttonClicked(activeConfigurator->clearButton);
 }
 
 void MainComponent::loadConfiguration()
 {
-	const ScopedLock myScopedLock (cs);
-
 	FileChooser myChooser ("Please select the configuration file you want to load...",
                                File::getSpecialLocation (File::userHomeDirectory),
                                "*.xml");
@@ -438,143 +386,65 @@ void MainComponent::loadConfiguration()
 		if (configurationElement->hasTagName ("Configuration"))
 		{
 			//Delete open configuration
-			while (nodes.size()>0)
-				deleteNode(nodes[0]);
+			clearConfiguration();
 
 			runningNodeID = 0;
 
-			forEachXmlChildElement (*configurationElement, e)
+			engine.loadConfiguration(*configurationElement);
+
+			//Creating the editor views of the loaded nodes
+			forEachXmlChildElementWithTagName (*configurationElement, e, "Node")
 			{
-				if (e->hasTagName ("Node"))
+				EngineNode* engineNode = engine.getNode(e->getIntAttribute ("id"));
+				if (engineNode==0)
+					continue;
+
+				Node* node;
+				if (engineNode->getType()==INPUTNODE)
 				{
-					int type = e->getIntAttribute ("type");
-					if (type==INPUTNODE)
-					{
-						OscInputNode* node;
-						node = new OscInputNode();
-						node->setID(e->getIntAttribute ("id"));
-						node->setOscManager(&oscManager);
-						node->addMouseListener(this, true);
-						
-						int connectorIndex=0;
-						forEachXmlChildElement (*e, ee)
-						{
-							if (ee->hasTagName ("Output"))
-							{
-								OutputConnector* outputConnector = new OutputConnector();
-								outputConnector->setID(connectorIndex);
-								outputConnector->setLabel(ee->getStringAttribute("label"));
-								node->pushOutputConnector(outputConnector);
-								node->addAndMakeVisible(outputConnector);
-								connectorIndex++;
-							}
-						}
-						
-						if (connectorIndex==0)
-						{
-							node->setSize(100, 40);
-						}
-						else
-							node->setSize(100, 20+connectorIndex*20);
-
-						node->resized();
-						
-						node->setTopLeftPosition(e->getIntAttribute("x"), e->getIntAttribute("y"));
-						node->setTitle(e->getStringAttribute("title"));
-						nodes.push_back(node);
-						addAndMakeVisible(node);
-
-						String address =e->getStringAttribute("address");
-						node->setAddress(address);
-						int port = e->getIntAttribute("port");
-						node->setPort(port);
-						oscManager.registerReceiver(address, node->getNumberOfOutputs(), port, node);
-					}
-					else if (type == CALIBRATORNODE)
+					OscInputNode* inputNode = new OscInputNode((OscInputEngineNode*)engineNode);
+					inputNode->setOscManager(&engine.oscManager);
+					node = inputNode;
+				}
+				else if (engineNode->getType()==CALIBRATORNODE)
+					node = new CalibratorNode((CalibratorEngineNode*)engineNode);
+				else
+					node = new OscOutputNode((OscOutputEngineNode*)engineNode);
+
+				node->addMouseListener(this, true);
+				node->setTopLeftPosition(e->getIntAttribute("x"), e->getIntAttribute("y"));
+				node->setTitle(e->getStringAttribute("title"));
+
+				int inputIndex=0;
+				int outputIndex=0;
+				forEachXmlChildElement (*e, ee)
+				{
+					if (ee->hasTagName ("Input") && inputIndex<node->getNumberOfInputs())
 					{
-						CalibratorNode* node = new CalibratorNode();
-						node->initialise(e->getIntAttribute("numberOfInputs"), e->getIntAttribute("numberOfOutputs"));
-						node->setID(e->getIntAttribute ("id"));
-						node->addMouseListener(this, true);
-						addAndMakeVisible(node);
-						node->setTopLeftPosition(e->getIntAttribute("x"), e->getIntAttribute("y"));
-						node->setTitle(e->getStringAttribute("title"));
-						nodes.push_back(node);
-
-						int inputIndex=0;
-						int outputIndex=0;
-						forEachXmlChildElement (*e, ee)
-						{
-							if (ee->hasTagName ("Output"))
-							{
-								node->getOutputConnector(outputIndex)->setLabel(ee->getStringAttribute("label"));
-								node->getOutputConnector(outputIndex)->setValue((float)ee->getDoubleAttribute("value"));
-								node->getConfigurator()->configureOutput(outputIndex, (float)ee->getDoubleAttribute("min"), (float)ee->getDoubleAttribute("max"), (float)ee->getDoubleAttribute("value"), ee->getBoolAttribute("minClip"),  ee->getBoolAttribute("maxClip"));
-								outputIndex++;
-							}
-							else if (ee->hasTagName ("Input"))
-							{	
-								node->getInputConnector(inputIndex)->setLabel(ee->getStringAttribute("label"));
-								inputIndex++;
-							}
-						}
-
-						String configuration = e->getStringAttribute("calibration");
-					//	node->getConfigurator()->getCalibrator()->setConfiguration(configuration.toCString());
-						node->getConfigurator()->getQhullCalibrator()->setConfiguration(configuration.toCString());
+						node->getInputConnector(inputIndex)->setLabel(ee->getStringAttribute("label"));
+						inputIndex++;
 					}
-					else if (type == OUTPUTNODE)
+					else if (ee->hasTagName ("Output") && outputIndex<node->getNumberOfOutputs())
 					{
-						OscOutputNode* node;
-						node = new OscOutputNode();
-						node->setID(e->getIntAttribute ("id"));
-						node->addMouseListener(this, true);
-
-						int connectorIndex=0;
-						forEachXmlChildElement (*e, ee)
-						{
-							if (ee->hasTagName ("Input"))
-							{
-								InputConnector* inputConnector = new InputConnector();
-								inputConnector->setID(connectorIndex);
-								inputConnector->setLabel(ee->getStringAttribute("label"));
-								node->pushInputConnector(inputConnector);
-								node->addAndMakeVisible(inputConnector);
-								connectorIndex++;
-							}
-						}
-						
-						if (connectorIndex==0)
-						{
-							node->setSize(100, 40);
-						}
-						else
-							node->setSize(100, 20+connectorIndex*20);
-
-						node->resized();
-						
-						node->setTopLeftPosition(e->getIntAttribute("x"), e->getIntAttribute("y"));
-						node->setTitle(e->getStringAttribute("title"));
-						nodes.push_back(node);
-						addAndMakeVisible(node);
-
-						node->setAddress(e->getStringAttribute("address"));
-						node->setHost(e->getStringAttribute("host"));
-						node->setPort(e->getIntAttribute("port"));
+						node->getOutputConnector(outputIndex)->setLabel(ee->getStringAttribute("label"));
+						outputIndex++;
 					}
 				}
-				else if (e->hasTagName ("Connection"))
-				{
-					connect(e->getIntAttribute("outNodeId"), e->getIntAttribute("outConnectorId"), e->getIntAttribute("inNodeId"), e->getIntAttribute("inConnectorId"));
-				}
 
-				for (unsigned int i=0; i<nodes.size(); i++)
-				{
-					if (runningNodeID<nodes[i]->getID())
-						runningNodeID=nodes[i]->getID();
-				}
+				nodes[node->getID()] = node;
+				addAndMakeVisible(node);
+			}
+
+			vector<Connection> connections = engine.getConnections();
+			for (unsigned int i=0; i<connections.size(); i++)
+			{
+				getNode(connections[i].outNodeId)->setConnectivityOfOutput(connections[i].outConnectorId, true);
+				getNode(connections[i].inNodeId)->setConnectivityOfInput(connections[i].inConnectorId, true);
 			}
 
+			if (runningNodeID<engine.getHighestID())
+				runningNodeID=engine.getHighestID();
+
 			//Cleaning up:
 			delete configurationElement;
 		}
@@ -582,6 +452,52 @@ void MainComponent::loadConfiguration()
     }
 }
 	
+void MainComponent::toggleCapture()
+{
+	PacketCapture& capture = engine.oscManager.getCapture();
+
+	if (capture.isCapturing())
+	{
+		capture.stop();
+
+		if (capture.getNumberOfDropped() > 0)
+			Logger::writeToLog("OscCalibrator: " + String(capture.getNumberOfDropped()) + " datagrams dropped from the capture");
+
+		return;
+	}
+
+	FileChooser myChooser ("Please select where you want to save the capture...",
+                               File::getSpecialLocation (File::userHomeDirectory),
+                               "*.osccap");
+
+	if (myChooser.browseForFileToSave(true))
+	{
+		if (!capture.start(myChooser.getResult()))
+			AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Capture", "Unable to write " + myChooser.getResult().getFullPathName());
+	}
+}
+
+void MainComponent::toggleTrace()
+{
+	TraceRecorder& recorder = engine.getTraceRecorder();
+
+	if (recorder.isBusy())
+	{
+		recorder.stop();
+		return;
+	}
+
+	FileChooser myChooser ("Please select where you want to save the trace...",
+                               File::getSpecialLocation (File::userHomeDirectory),
+                               "*.json");
+
+	if (myChooser.browseForFileToSave(true))
+	{
+		if (!recorder.start(myChooser.getResult(), 10))
+			AlertWindow::showMessageBox(AlertWindow::WarningIcon, "Trace", "Unable to write " + myChooser.getResult().getFullPathName());
+	}
+}
+
 void MainComponent::saveConfiguration()
 {
 	FileChooser myChooser ("Please select where you want to save the configuration file...",
@@ -593,86 +509,34 @@ void MainComponent::saveConfiguration()
         File configurationFile (myChooser.getResult());
 
 		XmlElement configurationElement("Configuration");
+		engine.saveConfiguration(configurationElement);
 
-		//Saving the nodes
-		for(unsigned int i=0; i<nodes.size(); i++)
+		//Adding what only the editor knows about: positions, titles and connector names
+		forEachXmlChildElementWithTagName (configurationElement, nodeElement, "Node")
 		{
-			XmlElement* nodeElement = new XmlElement("Node");
-			nodeElement->setAttribute("type", nodes[i]->getType());
-			nodeElement->setAttribute("id", nodes[i]->getID());
-			nodeElement->setAttribute("x", nodes[i]->getPosition().getX());
-			nodeElement->setAttribute("y", nodes[i]->getPosition().getY());
-			nodeElement->setAttribute("title", nodes[i]->getTitle());
-
-			if (nodes[i]->getType()==INPUTNODE)
-			{
-				nodeElement->setAttribute("address", ((OscInputNode*)nodes[i])->getAddress());
-				nodeElement->setAttribute("port", ((OscInputNode*)nodes[i])->getPort());
+			Node* node = getNode(nodeElement->getIntAttribute("id"));
+			if (node==0)
+				continue;
 
-				//Save the connector names
-				for (int ii=0; ii<nodes[i]->getNumberOfOutputs(); ii++)
-				{
-					XmlElement* connectorElement = new XmlElement("Output");
-					connectorElement->setAttribute("label", ((OscInputNode*)nodes[i])->getOutputConnector(ii)->getLabel());
-					nodeElement->addChildElement(connectorElement);
-				}
-			}
-			else if (nodes[i]->getType()==CALIBRATORNODE)
-			{
-				nodeElement->setAttribute("numberOfInputs", nodes[i]->getNumberOfInputs());
-				nodeElement->setAttribute("numberOfOutputs", nodes[i]->getNumberOfOutputs());
+			nodeElement->setAttribute("x", node->getPosition().getX());
+			nodeElement->setAttribute("y", node->getPosition().getY());
+			nodeElement->setAttribute("title", node->getTitle());
 
-				//Save the connector names
-				for (int ii=0; ii<nodes[i]->getNumberOfInputs(); ii++)
+			int inputIndex=0;
+			int outputIndex=0;
+			forEachXmlChildElement (*nodeElement, connectorElement)
+			{
+				if (connectorElement->hasTagName ("Input") && inputIndex<node->getNumberOfInputs())
 				{
-					XmlElement* connectorElement = new XmlElement("Input");
-					connectorElement->setAttribute("label", nodes[i]->getInputConnector(ii)->getLabel());
-					nodeElement->addChildElement(connectorElement);
+					connectorElement->setAttribute("label", node->getInputConnector(inputIndex)->getLabel());
+					inputIndex++;
 				}
-
-				for (int ii=0; ii<nodes[i]->getNumberOfOutputs(); ii++)
+				else if (connectorElement->hasTagName ("Output") && outputIndex<node->getNumberOfOutputs())
 				{
-					XmlElement* connectorElement = new XmlElement("Output");
-					connectorElement->setAttribute("label", nodes[i]->getOutputConnector(ii)->getLabel());
-					connectorElement->setAttribute("value", nodes[i]->getOutputConnector(ii)->getValue());
-					connectorElement->setAttribute("min", ((CalibratorNode*)nodes[i])->getOutputMin(ii));
-					connectorElement->setAttribute("max", ((CalibratorNode*)nodes[i])->getOutputMax(ii));
-					connectorElement->setAttribute("minClip", ((CalibratorNode*)nodes[i])->getMinClip(ii));
-					connectorElement->setAttribute("maxClip", ((CalibratorNode*)nodes[i])->getMaxClip(ii));
-					nodeElement->addChildElement(connectorElement);
+					connectorElement->setAttribute("label", node->getOutputConnector(outputIndex)->getLabel());
+					outputIndex++;
 				}
-
-				String calibration = ((CalibratorNode*)nodes[i])->getConfigurator()->getQhullCalibrator()->getConfiguration().c_str();
-				nodeElement->setAttribute("calibration", calibration);
-
 			}
-			else if (nodes[i]->getType()==OUTPUTNODE)
-			{
-				nodeElement->setAttribute("address", ((OscOutputNode*)nodes[i])->getAddress());
-				nodeElement->setAttribute("port", ((OscOutputNode*)nodes[i])->getPort());
-				nodeElement->setAttribute("host", ((OscOutputNode*)nodes[i])->getHost());
-
-				//Save the connector names
-				for (int ii=0; ii<nodes[i]->getNumberOfInputs(); ii++)
-				{
-					XmlElement* connectorElement = new XmlElement("Input");
-					connectorElement->setAttribute("label", ((OscInputNode*)nodes[i])->getInputConnector(ii)->getLabel());
-					nodeElement->addChildElement(connectorElement);
-				}
-			}
-
-			configurationElement.addChildElement(nodeElement);
-		}
-
-		for(unsigned int i=0; i<connections.size(); i++)
-		{
-			XmlElement* connectionElement = new XmlElement("Connection");
-			connectionElement->setAttribute("inConnectorId", connections[i].inConnectorId);
-			connectionElement->setAttribute("inNodeId", connections[i].inNodeId);
-			connectionElement->setAttribute("outConnectorId", connections[i].outConnectorId);
-			connectionElement->setAttribute("outNodeId", connections[i].outNodeId);
-
-			configurationElement.addChildElement(connectionElement);
 		}
 
 		if (configurationFile.hasFileExtension("xml"))
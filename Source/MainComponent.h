@@ -22,21 +22,15 @@
 #include "CalibratorConfigurator.h"
 #include "OscManager.h"
 #include "AboutComponent.h"
+#include "Engine.h"
 
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <unordered_map>
 using namespace std;
 
-struct Connection
-{
-	int outNodeId;
-	int outConnectorId;
-	int inNodeId;
-	int inConnectorId;
-};
-
-class MainComponent : public Component, public KeyListener
+class MainComponent : public Component, public KeyListener, public EngineListener, public Timer
 {
 public:
 	MainComponent(void);
@@ -57,24 +51,26 @@ public:
 	void deleteNode(Node* node);
 	void deleteConnectionsOfNode(Node* node);
 
-	void process();
+	void remoteAddCalibrationPoint();
+	void remoteClearCalibration();
+
+	void timerCallback(); //refreshes the statistics drawn over the nodes
 	
-	OscManager oscManager;
+	Engine engine;
 	CalibratorConfigurator* activeConfigurator;
 
 private:
-	vector<Node*> nodes;
-	vector<Connection> connections;
+	unordered_map<int, Node*> nodes; //the node views by id
 	int runningNodeID;
-	
-	void sortNodes();
 
 	Node* getNode(int Id);
-	static bool nodeSortPredicate(const Node* a, const Node* b);
-
-	CriticalSection cs;
+	void addNode(Node* node);
+	void releaseConnectors(const vector<Connection>& removed);
+	void clearConfiguration();
 
 	void loadConfiguration();
 	void saveConfiguration();
+	void toggleCapture();
+	void toggleTrace();
 };
 
@@ -14,6 +14,8 @@
 
 #include "Node.h"
 
+bool Node::showStatistics = false;
+
 Node::Node ()
     : title (0)
 {
@@ -27,10 +29,8 @@ Node::Node ()
 
     setSize (100, 40);
 
-	id = -1;
+	engineNode = 0;
 	selected=false;
-//	processingPriority = numeric_limits<int>::max();
-	processingPriority = 0;
 	type = -1; //unspecified
 }
 
@@ -51,6 +51,39 @@ void Node::paint (Graphics& g)
     g.fillAll (Colours::aliceblue);
 }
 
+void Node::paintOverChildren (Graphics& g)
+{
+	if (!showStatistics || engineNode == 0)
+		return;
+
+	StringArray lines = getStatisticsLines();
+	int lineHeight = 12;
+	int top = getHeight() - lines.size() * lineHeight;
+
+	g.setColour(Colours::black.withAlpha(0.6f));
+	g.fillRect(0, top, getWidth(), lines.size() * lineHeight);
+
+	g.setColour(Colours::white);
+	g.setFont(10.0f);
+
+	for (int i=0; i<lines.size(); i++)
+		g.drawText(lines[i], 2, top + i * lineHeight, getWidth() - 4, lineHeight, Justification::centredLeft, true);
+}
+
+StringArray Node::getStatisticsLines()
+{
+	StringArray lines;
+	ProfileCounter& profile = engineNode->getProcessProfile();
+
+	lines.add(String(profile.getCalls()) + "x, avg " + String(profile.getAverageMicroseconds(), 1) + " us");
+	lines.add("max " + String(profile.getMaxMicroseconds(), 0) + " us");
+
+	if (engineNode->getLatency().getCount() > 0)
+		lines.add("p99 latency " + String(engineNode->getLatency().getPercentile(0.99)) + " us");
+
+	return lines;
+}
+
 void Node::resized()
 {
     title->setBounds (0, 0, proportionOfWidth (1.0000f), 20);
@@ -84,12 +117,12 @@ void Node::mouseDrag(const MouseEvent& e)
 
 int Node::getID()
 {
-	return id;
+	return engineNode->getID();
 }
 
 void Node::setID(int Id)
 {
-	id=Id;
+	engineNode->setID(Id);
 }
 
 Point<int> Node::getInputConnectorLocalCoordinates(int Id)
@@ -186,34 +219,40 @@ bool Node::isAnOutputConnected()
 	return false;
 }
 
-float Node::getInputValue(int ConnectorIndex)
+void Node::createConnectors(int NumberOfInputs, int NumberOfOutputs)
 {
-	if (ConnectorIndex < (int)inputConnectors.size())
-		return inputConnectors[ConnectorIndex]->getValue();
-	else return 0;
-}
+	for (unsigned int i=0; i<outputConnectors.size(); i++)
+		deleteAndZero(outputConnectors[i]);
+	outputConnectors.clear();
 
-float Node::getOutputValue(int ConnectorIndex)
-{
-	if (ConnectorIndex < (int)outputConnectors.size())
-		return outputConnectors[ConnectorIndex]->getValue();
-	else return 0;
-}
+	for (unsigned int i=0; i<inputConnectors.size(); i++)
+		deleteAndZero(inputConnectors[i]);
+	inputConnectors.clear();
 
-void Node::setInputValue(int ConnectorIndex, float Value)
-{
-	if (ConnectorIndex < (int)inputConnectors.size())
-		inputConnectors[ConnectorIndex]->setValue(Value);
-}
+	for (int i=0; i<NumberOfInputs; i++)
+	{
+		InputConnector* inputConnector = new InputConnector();
+		inputConnector->setID(i);
+		addAndMakeVisible(inputConnector);
+		inputConnectors.push_back(inputConnector);
+	}
 
-void Node::setOutputValue(int ConnectorIndex, float Value)
-{
-	if (ConnectorIndex < (int)outputConnectors.size())
-		outputConnectors[ConnectorIndex]->setValue(Value);
-}
+	for (int i=0; i<NumberOfOutputs; i++)
+	{
+		OutputConnector* outputConnector = new OutputConnector();
+		outputConnector->setID(i);
+		addAndMakeVisible(outputConnector);
+		outputConnectors.push_back(outputConnector);
+	}
 
-void Node::process()
-{
+	if (outputConnectors.size()==0 && inputConnectors.size()==0)
+	{
+		setSize(100, 40);
+	}
+	else
+		setSize(100, 20+outputConnectors.size()*20+inputConnectors.size()*20);
+
+	resized();
 }
 
 int Node::getType()
@@ -17,15 +17,13 @@
 #include "..\juce\juce_amalgamated.h"
 #include "OutputConnector.h"
 #include "InputConnector.h"
+#include "EngineNode.h"
 
 #include <vector>
 #include <limits>
 using namespace std;
 
-#define INPUTNODE 0
-#define CALIBRATORNODE 1
-#define OUTPUTNODE 2
-
+//The editor view of an engine node
 class Node  : public Component
 {
 public:
@@ -34,6 +32,7 @@ public:
     ~Node();
 
     void paint (Graphics& g);
+    void paintOverChildren (Graphics& g);
     void resized();
 
 	void mouseDrag(const MouseEvent& e);
@@ -57,23 +56,19 @@ public:
 	bool isAnInputConnected();
 	bool isAnOutputConnected();
 
-	float getInputValue(int ConnectorIndex);
-	float getOutputValue(int ConnectorIndex);
-	void setInputValue(int ConnectorIndex, float Value);
-	void setOutputValue(int ConnectorIndex, float Value);
-
-	int processingPriority;
-
 	int getType();
 	String getTitle();
 	void setTitle(String title);
 	OutputConnector* getOutputConnector(int index) {return outputConnectors[index];};
 	InputConnector* getInputConnector(int index) {return inputConnectors[index];};
-	void pushOutputConnector(OutputConnector* outputConnector) {outputConnectors.push_back(outputConnector);};
-	void pushInputConnector(InputConnector* inputConnector) {inputConnectors.push_back(inputConnector);};
+	void createConnectors(int NumberOfInputs, int NumberOfOutputs);
+
+	EngineNode* getEngineNode() {return engineNode;};
 
-	virtual void process();
-	
+	//The processing statistics drawn over all node views, while switched on
+	static void setShowStatistics(bool State) {showStatistics=State;};
+	static bool isShowingStatistics() {return showStatistics;};
+	virtual StringArray getStatisticsLines();
 
     //==============================================================================
     juce_UseDebuggingNewOperator
@@ -83,12 +78,13 @@ protected:
     Label* title;
 	vector<OutputConnector*> outputConnectors;
 	vector<InputConnector*> inputConnectors;
-	int id;
+	EngineNode* engineNode; //owned by the engine
 	bool selected;
 	int type;
 
 private:
 	ComponentDragger dragger;
+	static bool showStatistics;
 
     //==============================================================================
     // (prevent copy constructor and operator= being generated..)
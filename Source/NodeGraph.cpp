@@ -0,0 +1,586 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "NodeGraph.h"
+#include "TraceRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+NodeGraph::NodeGraph()
+{
+	visitMark = 0;
+	nextJoinDeadline = 0;
+}
+
+NodeGraph::~NodeGraph()
+{
+	clear();
+}
+
+void NodeGraph::addNode(EngineNode* node)
+{
+	Entry* entry = new Entry();
+	entry->node = node;
+	entry->position = (int)order.size();
+	entry->visited = 0;
+	entry->fresh = false;
+	entry->pendingSince = 0;
+	entry->ticks = 0;
+
+	entries[node->getID()] = entry;
+	order.push_back(entry); //A node without connections can go anywhere, so the end of the order is fine
+}
+
+void NodeGraph::removeNode(EngineNode* node)
+{
+	Entry* entry = getEntry(node->getID());
+
+	if (entry==0 || entry->node!=node)
+		return;
+
+	disconnectNode(node->getID());
+
+	int position = entry->position;
+	order.erase(order.begin()+position);
+	renumber(position);
+
+	entries.erase(node->getID());
+	delete entry;
+}
+
+void NodeGraph::clear()
+{
+	for (unsigned int i=0; i<order.size(); i++)
+		delete order[i];
+
+	order.clear();
+	entries.clear();
+}
+
+EngineNode* NodeGraph::getNode(int Id)
+{
+	Entry* entry = getEntry(Id);
+
+	if (entry)
+		return entry->node;
+	else
+		return 0;
+}
+
+int NodeGraph::getHighestID()
+{
+	int result = -1;
+
+	for (unsigned int i=0; i<order.size(); i++)
+		if (order[i]->node->getID() > result)
+			result = order[i]->node->getID();
+
+	return result;
+}
+
+bool NodeGraph::connect(const Connection& connection)
+{
+	if (connection.outNodeId == connection.inNodeId)
+		return false;
+
+	Entry* outEntry = getEntry(connection.outNodeId);
+	Entry* inEntry = getEntry(connection.inNodeId);
+
+	if (outEntry==0 || inEntry==0)
+		return false;
+
+	//Check if inConnector already connected
+	for (unsigned int i=0; i<inEntry->inputs.size(); i++)
+		if (inEntry->inputs[i].connection.inConnectorId == connection.inConnectorId)
+			return false;
+
+	//If the new connection goes against the current order, the affected nodes are moved.
+	//This fails if the connection would close a loop.
+	if (outEntry->position > inEntry->position && !reorder(outEntry, inEntry))
+		return false;
+
+	addEdge(outEntry, inEntry, connection);
+
+	return true;
+}
+
+//Adds the connections without maintaining the order on the way, then sorts the nodes once.
+//If they contain a loop, they are taken back and connected one by one, which rejects the
+//ones closing a loop. Returns the number of connections made.
+int NodeGraph::connectAll(const vector<Connection>& Connections)
+{
+	vector<Connection> added;
+	added.reserve(Connections.size());
+
+	for (unsigned int i=0; i<Connections.size(); i++)
+	{
+		const Connection& connection = Connections[i];
+
+		if (connection.outNodeId == connection.inNodeId || isInputConnected(connection.inNodeId, connection.inConnectorId))
+			continue;
+
+		Entry* outEntry = getEntry(connection.outNodeId);
+		Entry* inEntry = getEntry(connection.inNodeId);
+
+		if (outEntry==0 || inEntry==0)
+			continue;
+
+		addEdge(outEntry, inEntry, connection);
+		added.push_back(connection);
+	}
+
+	if (sortNodes())
+		return (int)added.size();
+
+	for (unsigned int i=0; i<added.size(); i++)
+	{
+		removeEdge(getEntry(added[i].outNodeId)->outputs, added[i]);
+		removeEdge(getEntry(added[i].inNodeId)->inputs, added[i]);
+	}
+
+	int result = 0;
+	for (unsigned int i=0; i<added.size(); i++)
+		if (connect(added[i]))
+			result++;
+
+	return result;
+}
+
+void NodeGraph::addEdge(Entry* outEntry, Entry* inEntry, const Connection& connection)
+{
+	Edge edge;
+	edge.connection = connection;
+	edge.pending = false;
+	edge.value = 0;
+	edge.ticks = 0;
+
+	edge.peer = inEntry;
+	outEntry->outputs.push_back(edge);
+
+	edge.peer = outEntry;
+	inEntry->inputs.push_back(edge);
+
+	inEntry->node->markUpdated(); //the new input has to be evaluated even if its value happens to be unchanged
+}
+
+bool NodeGraph::disconnectInput(int NodeId, int InputId, Connection& removed)
+{
+	Entry* entry = getEntry(NodeId);
+
+	if (entry==0)
+		return false;
+
+	for (unsigned int i=0; i<entry->inputs.size(); i++)
+	{
+		if (entry->inputs[i].connection.inConnectorId == InputId)
+		{
+			removed = entry->inputs[i].connection;
+			removeEdge(entry->inputs[i].peer->outputs, removed);
+			entry->inputs.erase(entry->inputs.begin()+i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+vector<Connection> NodeGraph::disconnectOutput(int NodeId, int OutputId)
+{
+	vector<Connection> result;
+	Entry* entry = getEntry(NodeId);
+
+	if (entry==0)
+		return result;
+
+	unsigned int i=0;
+	while (i<entry->outputs.size())
+	{
+		if (entry->outputs[i].connection.outConnectorId == OutputId)
+		{
+			result.push_back(entry->outputs[i].connection);
+			removeEdge(entry->outputs[i].peer->inputs, entry->outputs[i].connection);
+			entry->outputs.erase(entry->outputs.begin()+i);
+		}
+		else
+			i++;
+	}
+
+	return result;
+}
+
+vector<Connection> NodeGraph::disconnectNode(int NodeId)
+{
+	vector<Connection> result;
+	Entry* entry = getEntry(NodeId);
+
+	if (entry==0)
+		return result;
+
+	for (unsigned int i=0; i<entry->inputs.size(); i++)
+	{
+		result.push_back(entry->inputs[i].connection);
+		removeEdge(entry->inputs[i].peer->outputs, entry->inputs[i].connection);
+	}
+
+	for (unsigned int i=0; i<entry->outputs.size(); i++)
+	{
+		result.push_back(entry->outputs[i].connection);
+		removeEdge(entry->outputs[i].peer->inputs, entry->outputs[i].connection);
+	}
+
+	entry->inputs.clear();
+	entry->outputs.clear();
+
+	return result;
+}
+
+bool NodeGraph::isInputConnected(int NodeId, int InputId)
+{
+	Entry* entry = getEntry(NodeId);
+
+	if (entry)
+		for (unsigned int i=0; i<entry->inputs.size(); i++)
+			if (entry->inputs[i].connection.inConnectorId == InputId)
+				return true;
+
+	return false;
+}
+
+bool NodeGraph::isOutputConnected(int NodeId, int OutputId)
+{
+	Entry* entry = getEntry(NodeId);
+
+	if (entry)
+		for (unsigned int i=0; i<entry->outputs.size(); i++)
+			if (entry->outputs[i].connection.outConnectorId == OutputId)
+				return true;
+
+	return false;
+}
+
+vector<Connection> NodeGraph::getConnections()
+{
+	vector<Connection> result;
+
+	for (unsigned int i=0; i<order.size(); i++)
+		for (unsigned int j=0; j<order[i]->outputs.size(); j++)
+			result.push_back(order[i]->outputs[j].connection);
+
+	return result;
+}
+
+//Kahn's algorithm, keeping the current order among nodes that are ready at the same time.
+//Returns false, leaving the order as it is, if the connections contain a loop.
+bool NodeGraph::sortNodes()
+{
+	vector<Entry*> sorted;
+	sorted.reserve(order.size());
+
+	vector<int> predecessors(order.size()); //not yet sorted, by current position
+	for (unsigned int i=0; i<order.size(); i++)
+	{
+		predecessors[i] = (int)order[i]->inputs.size();
+
+		if (predecessors[i] == 0)
+			sorted.push_back(order[i]);
+	}
+
+	for (unsigned int i=0; i<sorted.size(); i++)
+	{
+		for (unsigned int j=0; j<sorted[i]->outputs.size(); j++)
+		{
+			Entry* peer = sorted[i]->outputs[j].peer;
+
+			if (--predecessors[peer->position] == 0)
+				sorted.push_back(peer);
+		}
+	}
+
+	if (sorted.size() != order.size())
+		return false;
+
+	order = sorted;
+	renumber(0);
+	return true;
+}
+
+void NodeGraph::process()
+{
+	runPass(true);
+}
+
+void NodeGraph::processExpiredJoins() //Evaluates the joining nodes that have waited for their inputs for longer than their timeout
+{
+	if (nextJoinDeadline == 0 || Time::getMillisecondCounterHiRes() < nextJoinDeadline)
+		return;
+
+	runPass(false);
+}
+
+//Propagates the data over the connections and calls the process function of the nodes.
+//A node is evaluated if it or one of its inputs has been updated in this pass. Joining nodes are only evaluated once
+//all connected inputs have been updated since their last evaluation, or once their join timeout has passed.
+//Nodes whose input values are bit-identical to their last evaluation keep their previous outputs and are not processed.
+void NodeGraph::runPass(bool SourcesUpdated)
+{
+	double now = Time::getMillisecondCounterHiRes();
+	nextJoinDeadline = 0;
+
+	for (unsigned int i=0; i<order.size(); i++)
+	{
+		Entry* entry = order[i];
+		EngineNode* node = entry->node;
+
+		if (entry->inputs.empty())
+		{
+			entry->fresh = SourcesUpdated && node->takeUpdate();
+
+			if (entry->fresh)
+			{
+				//The stamp is taken, so values set without receiving anything aren't traced
+				entry->ticks = node->getReceiveTicks();
+				node->setReceiveTicks(0);
+
+				int64 start = Time::getHighResolutionTicks();
+				{
+					TraceScope trace(getTraceName(node), node->getID());
+					node->process();
+				}
+				int64 end = Time::getHighResolutionTicks();
+
+				node->getProcessProfile().add(end - start);
+				node->getLatency().recordSince(entry->ticks, end);
+			}
+
+			continue;
+		}
+
+		bool anyUpdated = false;
+		bool allPending = true;
+		bool forced = node->takeUpdate();
+
+		for (unsigned int j=0; j<entry->inputs.size(); j++)
+		{
+			Edge& edge = entry->inputs[j];
+
+			if (edge.peer->fresh)
+			{
+				anyUpdated = true;
+
+				if (!edge.pending || edge.ticks == 0)
+					edge.ticks = edge.peer->ticks;
+
+				edge.pending = true;
+			}
+			else if (!edge.pending)
+				allPending = false;
+		}
+
+		entry->fresh = false;
+
+		if (node->isJoining() && !forced)
+		{
+			if (anyUpdated && entry->pendingSince == 0)
+				entry->pendingSince = now;
+
+			if (entry->pendingSince == 0)
+				continue;
+
+			int timeout = node->getJoinTimeout();
+
+			if (!allPending && (timeout <= 0 || now < entry->pendingSince + timeout))
+			{
+				if (timeout > 0 && (nextJoinDeadline == 0 || entry->pendingSince + timeout < nextJoinDeadline))
+					nextJoinDeadline = entry->pendingSince + timeout;
+
+				continue;
+			}
+		}
+		else if (!anyUpdated && !forced)
+			continue;
+
+		bool changed = forced;
+		int64 ticks = 0;
+
+		for (unsigned int j=0; j<entry->inputs.size(); j++)
+		{
+			Edge& edge = entry->inputs[j];
+			float value = edge.peer->node->getOutputValue(edge.connection.outConnectorId);
+
+			if (edge.pending && edge.ticks != 0 && (ticks == 0 || edge.ticks < ticks))
+				ticks = edge.ticks;
+
+			if (memcmp(&value, &edge.value, sizeof(float)) != 0)
+			{
+				changed = true;
+				edge.value = value;
+			}
+
+			node->setInputValue(edge.connection.inConnectorId, value);
+			edge.pending = false;
+			edge.ticks = 0;
+		}
+
+		entry->pendingSince = 0;
+		entry->fresh = changed;
+
+		if (changed)
+		{
+			entry->ticks = ticks;
+			node->setReceiveTicks(ticks);
+
+			int64 start = Time::getHighResolutionTicks();
+			{
+				TraceScope trace(getTraceName(node), node->getID());
+				node->process();
+			}
+			int64 end = Time::getHighResolutionTicks();
+
+			node->getProcessProfile().add(end - start);
+			node->getLatency().recordSince(ticks, end);
+		}
+	}
+}
+
+const char* NodeGraph::getTraceName(EngineNode* node)
+{
+	switch (node->getType())
+	{
+	case INPUTNODE: return "input node";
+	case CALIBRATORNODE: return "calibrator node";
+	case OUTPUTNODE: return "output node";
+	default: return "node";
+	}
+}
+
+NodeGraph::Entry* NodeGraph::getEntry(int Id)
+{
+	unordered_map<int, Entry*>::iterator it = entries.find(Id);
+
+	if (it != entries.end())
+		return it->second;
+	else
+		return 0;
+}
+
+void NodeGraph::removeEdge(vector<Edge>& edges, const Connection& connection)
+{
+	for (unsigned int i=0; i<edges.size(); i++)
+	{
+		const Connection& c = edges[i].connection;
+
+		if (c.outNodeId==connection.outNodeId && c.outConnectorId==connection.outConnectorId &&
+			c.inNodeId==connection.inNodeId && c.inConnectorId==connection.inConnectorId)
+		{
+			edges.erase(edges.begin()+i);
+			return;
+		}
+	}
+}
+
+void NodeGraph::renumber(int from)
+{
+	for (int i=from; i<(int)order.size(); i++)
+		order[i]->position = i;
+}
+
+//Incremental reordering for a new connection outEntry -> inEntry where outEntry currently comes after inEntry.
+//Only the nodes between the two positions that are reachable from inEntry, or that reach outEntry, are moved:
+//the ones reaching outEntry take the lower of their positions, followed by the ones reachable from inEntry.
+bool NodeGraph::reorder(Entry* outEntry, Entry* inEntry)
+{
+	int lower = inEntry->position;
+	int upper = outEntry->position;
+
+	visitMark++;
+
+	vector<Entry*> stack;
+	vector<Entry*> forward;
+	vector<Entry*> backward;
+
+	inEntry->visited = visitMark;
+	stack.push_back(inEntry);
+
+	while (!stack.empty())
+	{
+		Entry* entry = stack.back();
+		stack.pop_back();
+		forward.push_back(entry);
+
+		for (unsigned int i=0; i<entry->outputs.size(); i++)
+		{
+			Entry* peer = entry->outputs[i].peer;
+
+			if (peer == outEntry) //Loop
+				return false;
+
+			if (peer->visited != visitMark && peer->position < upper)
+			{
+				peer->visited = visitMark;
+				stack.push_back(peer);
+			}
+		}
+	}
+
+	outEntry->visited = visitMark;
+	stack.push_back(outEntry);
+
+	while (!stack.empty())
+	{
+		Entry* entry = stack.back();
+		stack.pop_back();
+		backward.push_back(entry);
+
+		for (unsigned int i=0; i<entry->inputs.size(); i++)
+		{
+			Entry* peer = entry->inputs[i].peer;
+
+			if (peer->visited != visitMark && peer->position > lower)
+			{
+				peer->visited = visitMark;
+				stack.push_back(peer);
+			}
+		}
+	}
+
+	sort(forward.begin(), forward.end(), &NodeGraph::positionSortPredicate);
+	sort(backward.begin(), backward.end(), &NodeGraph::positionSortPredicate);
+
+	vector<int> positions;
+	for (unsigned int i=0; i<backward.size(); i++)
+		positions.push_back(backward[i]->position);
+	for (unsigned int i=0; i<forward.size(); i++)
+		positions.push_back(forward[i]->position);
+	sort(positions.begin(), positions.end());
+
+	int index=0;
+	for (unsigned int i=0; i<backward.size(); i++)
+	{
+		backward[i]->position = positions[index++];
+		order[backward[i]->position] = backward[i];
+	}
+	for (unsigned int i=0; i<forward.size(); i++)
+	{
+		forward[i]->position = positions[index++];
+		order[forward[i]->position] = forward[i];
+	}
+
+	return true;
+}
+
+bool NodeGraph::positionSortPredicate(const Entry* a, const Entry* b)
+{
+	return a->position < b->position;
+}
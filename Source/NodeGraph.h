@@ -0,0 +1,101 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "EngineNode.h"
+
+#include <vector>
+#include <unordered_map>
+using namespace std;
+
+struct Connection
+{
+	int outNodeId;
+	int outConnectorId;
+	int inNodeId;
+	int inConnectorId;
+};
+
+//The processing graph: nodes indexed by id, with per-node lists of incoming and outgoing
+//connections, and the nodes kept in a topological processing order.
+class NodeGraph
+{
+public:
+	NodeGraph();
+	~NodeGraph();
+
+	void addNode(EngineNode* node);
+	void removeNode(EngineNode* node);
+	void clear();
+
+	EngineNode* getNode(int Id);
+	int getNumberOfNodes() {return (int)order.size();};
+	EngineNode* getNodeInOrder(int index) {return order[index]->node;};
+	int getHighestID();
+
+	bool connect(const Connection& connection);
+	int connectAll(const vector<Connection>& Connections); //for loading, see the implementation
+	bool disconnectInput(int NodeId, int InputId, Connection& removed);
+	vector<Connection> disconnectOutput(int NodeId, int OutputId);
+	vector<Connection> disconnectNode(int NodeId);
+
+	bool isInputConnected(int NodeId, int InputId);
+	bool isOutputConnected(int NodeId, int OutputId);
+
+	vector<Connection> getConnections();
+
+	bool sortNodes();
+	void process();
+	void processExpiredJoins();
+
+private:
+	struct Entry;
+
+	struct Edge
+	{
+		Connection connection;
+		Entry* peer;
+		bool pending; //input side only: the peer has been updated since this node was last evaluated
+		float value; //input side only: the value passed on in the last evaluation
+		int64 ticks; //input side only: receive time of the oldest update pending on this input, 0 if none
+	};
+
+	struct Entry
+	{
+		EngineNode* node;
+		vector<Edge> inputs;
+		vector<Edge> outputs;
+		int position;
+		int visited;
+		bool fresh; //evaluated with changed inputs in the current pass
+		double pendingSince; //joining nodes: time of the first pending input update
+		int64 ticks; //receive time of the oldest received value behind the outputs, 0 if none
+	};
+
+	unordered_map<int, Entry*> entries;
+	vector<Entry*> order;
+	int visitMark;
+	double nextJoinDeadline;
+
+	Entry* getEntry(int Id);
+	void addEdge(Entry* outEntry, Entry* inEntry, const Connection& connection);
+	void removeEdge(vector<Edge>& edges, const Connection& connection);
+	void renumber(int from);
+	bool reorder(Entry* outEntry, Entry* inEntry);
+	void runPass(bool SourcesUpdated);
+	static bool positionSortPredicate(const Entry* a, const Entry* b);
+	static const char* getTraceName(EngineNode* node);
+};
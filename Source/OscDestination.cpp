@@ -0,0 +1,196 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "OscDestination.h"
+#include "../oscpack/osc/OscByteSwap.h"
+#include "TraceRecorder.h"
+
+static void appendInt32(vector<char>& data, unsigned int value) //big endian, as in OSC
+{
+	data.push_back((char)((value >> 24) & 0xFF));
+	data.push_back((char)((value >> 16) & 0xFF));
+	data.push_back((char)((value >> 8) & 0xFF));
+	data.push_back((char)(value & 0xFF));
+}
+
+static void appendPaddedString(vector<char>& data, const char* text) //zero terminated, padded to 4 bytes
+{
+	while (*text)
+		data.push_back(*text++);
+
+	do
+		data.push_back(0);
+	while (data.size() % 4 != 0);
+}
+
+
+OscMessageTemplate::OscMessageTemplate()
+{
+	setAddress("/", 0);
+}
+
+OscMessageTemplate::~OscMessageTemplate()
+{
+
+}
+
+void OscMessageTemplate::setAddress(const String& Address, int NumberOfArguments)
+{
+	numberOfArguments = NumberOfArguments;
+
+	data.clear();
+	appendPaddedString(data, Address.toCString());
+	appendPaddedString(data, (String(",") + String::repeatedString("f", NumberOfArguments)).toCString());
+
+	argumentsOffset = (int)data.size();
+	data.resize(argumentsOffset + 4*NumberOfArguments, 0);
+}
+
+void OscMessageTemplate::setArguments(const float* Values)
+{
+	osc::CopyBigEndian32(&data[argumentsOffset], (const char*)Values, numberOfArguments);
+}
+
+
+OscDestination::OscDestination(const String& Host, int Port)
+{
+	host = Host;
+	port = Port;
+	socket = 0;
+	ring = 0;
+	sender = 0;
+	multicast = false;
+
+	if (SharedMemoryRing::isRingAddress(Host))
+	{
+		ring = new SharedMemoryRing();
+		if (!ring->open(SharedMemoryRing::getRingName(Host)))
+			Logger::writeToLog("OscCalibrator: unable to open the shared memory ring " + Host);
+	}
+	else if (TcpSender::isTcpAddress(Host))
+	{
+		sender = new TcpSender(TcpSender::getTcpName(Host), Port);
+		sender->startThread();
+	}
+	else
+	{
+		IpEndpointName endpoint(Host.toCString(), Port);
+
+		socket = new UdpTransmitSocket(endpoint);
+		multicast = endpoint.IsMulticastAddress();
+	}
+
+	openBundle = -1;
+	references = 0;
+}
+
+OscDestination::~OscDestination()
+{
+	delete socket;
+	delete ring;
+	delete sender;
+}
+
+void OscDestination::setMulticastOptions(int Ttl, const String& Interface)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (!multicast)
+		return;
+
+	socket->SetMulticastTtl(Ttl);
+	socket->SetMulticastInterface(resolveInterface(Interface));
+}
+
+unsigned long OscDestination::resolveInterface(const String& Interface)
+{
+	if (Interface.isEmpty())
+		return IpEndpointName::ANY_ADDRESS;
+	else
+		return IpEndpointName(Interface.toCString()).address;
+}
+
+void OscDestination::queue(const char* Data, int Size, bool Bundled, osc::uint64 TimeTag)
+{
+	const ScopedLock myScopedLock (cs);
+
+	//The open bundle is always the last pending packet, so the message can be appended to it
+	if (Bundled && openBundle != -1 && openBundleTimeTag == TimeTag && pendingPackets[openBundle].size + 4 + Size <= OUTPUT_MTU)
+	{
+		appendInt32(pendingData, Size);
+		pendingData.insert(pendingData.end(), Data, Data+Size);
+		pendingPackets[openBundle].size += 4 + Size;
+		return;
+	}
+
+	PendingPacket packet;
+	packet.offset = (int)pendingData.size();
+
+	if (Bundled && 16 + 4 + Size <= OUTPUT_MTU)
+	{
+		static const char bundleHeader[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0};
+
+		pendingData.insert(pendingData.end(), bundleHeader, bundleHeader+8);
+		appendInt32(pendingData, (unsigned int)(TimeTag >> 32));
+		appendInt32(pendingData, (unsigned int)(TimeTag & 0xFFFFFFFF));
+		appendInt32(pendingData, Size);
+		pendingData.insert(pendingData.end(), Data, Data+Size);
+
+		packet.size = 16 + 4 + Size;
+		openBundle = (int)pendingPackets.size();
+		openBundleTimeTag = TimeTag;
+	}
+	else
+	{
+		pendingData.insert(pendingData.end(), Data, Data+Size);
+
+		packet.size = Size;
+		openBundle = -1;
+	}
+
+	pendingPackets.push_back(packet);
+}
+
+void OscDestination::flush()
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (pendingPackets.empty())
+		return;
+
+	TraceScope trace("send");
+
+	flushData.clear();
+	flushSizes.clear();
+	for (unsigned int i=0; i<pendingPackets.size(); i++)
+	{
+		flushData.push_back(&pendingData[pendingPackets[i].offset]);
+		flushSizes.push_back(pendingPackets[i].size);
+	}
+
+	if (socket)
+		socket->SendMultiple(&flushData[0], &flushSizes[0], (int)flushData.size());
+	else if (sender)
+		sender->send(&flushData[0], &flushSizes[0], (int)flushData.size());
+	else if (ring->isOpen())
+	{
+		//Packets that don't fit are dropped, like datagrams the receiver has no room for
+		for (unsigned int i=0; i<flushData.size(); i++)
+			ring->write(flushData[i], flushSizes[i]);
+	}
+
+	pendingData.clear();
+	pendingPackets.clear();
+	openBundle = -1;
+}
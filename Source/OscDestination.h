@@ -0,0 +1,105 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "../oscpack/ip/UdpSocket.h"
+#include "../oscpack/osc/OscTypes.h"
+#include "..\juce\juce_amalgamated.h"
+#include "SharedMemoryRing.h"
+#include "SlipTcp.h"
+
+#include <vector>
+using namespace std;
+
+#define OUTPUT_MTU 1472 //the largest UDP payload that isn't fragmented on ethernet
+
+//An OSC message whose address and type tags are encoded once; sending only rewrites the
+//big endian float arguments in place.
+class OscMessageTemplate
+{
+public:
+	OscMessageTemplate();
+	~OscMessageTemplate();
+
+	void setAddress(const String& Address, int NumberOfArguments);
+	int getNumberOfArguments() {return numberOfArguments;};
+
+	void setArguments(const float* Values);
+
+	const char* getData() {return &data[0];};
+	int getSize() {return (int)data.size();};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	vector<char> data;
+	int argumentsOffset;
+	int numberOfArguments;
+};
+
+//A host and port resolved once, shared by all output nodes sending there. The packets of a
+//processing pass are queued and sent together by flush. All methods are thread safe.
+//A host "shm://name" writes the packets to that shared memory ring instead; the port is unused.
+//A host "tcp://hostname" sends them SLIP framed over a TCP connection to the port.
+//A multicast group as host serves every receiver that joined it with one send.
+class OscDestination
+{
+public:
+	OscDestination(const String& Host, int Port);
+	~OscDestination();
+
+	const String& getHost() {return host;};
+	int getPort() {return port;};
+
+	//Applies to multicast group destinations only. An empty Interface sends on the default one.
+	void setMulticastOptions(int Ttl, const String& Interface);
+
+	//The address of an interface given as "a.b.c.d" or host name, or any for an empty string
+	static unsigned long resolveInterface(const String& Interface);
+
+	//Bundled messages are packed into bundles of up to OUTPUT_MTU bytes, one for each time tag
+	void queue(const char* Data, int Size, bool Bundled, osc::uint64 TimeTag);
+	void flush();
+
+	int references; //the output nodes using this destination, maintained by the OscManager
+
+	juce_UseDebuggingNewOperator
+
+private:
+	struct PendingPacket
+	{
+		int offset;
+		int size;
+	};
+
+	String host;
+	int port;
+	UdpTransmitSocket* socket;
+	SharedMemoryRing* ring;
+	TcpSender* sender;
+	bool multicast;
+
+	vector<char> pendingData;
+	vector<PendingPacket> pendingPackets;
+	int openBundle; //the pending packet that further bundled messages are added to, -1 if none
+	osc::uint64 openBundleTimeTag;
+	vector<const char*> flushData;
+	vector<int> flushSizes;
+
+	CriticalSection cs;
+
+	OscDestination (const OscDestination&);
+	const OscDestination& operator= (const OscDestination&);
+};
@@ -0,0 +1,157 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "OscDispatchTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+static bool isAddressWhitespace(char c)
+{
+	return c==' ' || c=='\t' || c=='\r' || c=='\n';
+}
+
+OscDispatchTable::OscDispatchTable()
+{
+	numberOfReceivers = 0;
+}
+
+OscDispatchTable::~OscDispatchTable()
+{
+}
+
+void OscDispatchTable::clear()
+{
+	ports.clear();
+	numberOfReceivers = 0;
+}
+
+void OscDispatchTable::add(int Port, const String& Address, int ReceiverIndex)
+{
+	string address = Address.trim().toCString();
+	PortTable& table = ports[Port];
+
+	size_t wildcard = address.find_first_of("*?");
+	if (wildcard == string::npos)
+	{
+		Literal literal;
+		literal.address = address;
+		literal.receiverIndex = ReceiverIndex;
+		table.literals[hash(address.c_str(), address.size())].push_back(literal);
+	}
+	else
+	{
+		Pattern pattern;
+		pattern.pattern = address;
+		pattern.prefixLength = wildcard;
+		pattern.receiverIndex = ReceiverIndex;
+		table.patterns.push_back(pattern);
+	}
+
+	numberOfReceivers++;
+}
+
+void OscDispatchTable::match(int Port, const char* Address, vector<int>& Matches) const
+{
+	unordered_map<int, PortTable>::const_iterator port = ports.find(Port);
+	if (port == ports.end())
+		return;
+
+	const PortTable& table = port->second;
+
+	//Incoming addresses are compared trimmed, as the registered ones
+	while (isAddressWhitespace(*Address))
+		Address++;
+	size_t length = strlen(Address);
+	while (length > 0 && isAddressWhitespace(Address[length-1]))
+		length--;
+
+	size_t first = Matches.size();
+
+	unordered_map<unsigned int, vector<Literal> >::const_iterator bucket = table.literals.find(hash(Address, length));
+	if (bucket != table.literals.end())
+	{
+		for (unsigned int i=0; i<bucket->second.size(); i++)
+		{
+			const Literal& literal = bucket->second[i];
+			if (literal.address.size()==length && memcmp(literal.address.c_str(), Address, length)==0)
+				Matches.push_back(literal.receiverIndex);
+		}
+	}
+
+	bool literalsMatched = Matches.size() > first;
+
+	for (unsigned int i=0; i<table.patterns.size(); i++)
+	{
+		const Pattern& pattern = table.patterns[i];
+
+		if (length < pattern.prefixLength || memcmp(pattern.pattern.c_str(), Address, pattern.prefixLength)!=0)
+			continue;
+
+		if (matchesWildcard(Address+pattern.prefixLength, length-pattern.prefixLength, pattern.pattern.c_str()+pattern.prefixLength, pattern.pattern.size()-pattern.prefixLength))
+			Matches.push_back(pattern.receiverIndex);
+	}
+
+	//Keeps the registration order when both literal and wildcard receivers matched
+	if (literalsMatched && table.patterns.size() > 0)
+		sort(Matches.begin()+first, Matches.end());
+}
+
+unsigned int OscDispatchTable::hash(const char* Address, size_t Length)
+{
+	//FNV-1a
+	unsigned int result = 2166136261u;
+	for (size_t i=0; i<Length; i++)
+	{
+		result ^= (unsigned char)Address[i];
+		result *= 16777619u;
+	}
+	return result;
+}
+
+bool OscDispatchTable::matchesWildcard(const char* Address, size_t AddressLength, const char* Pattern, size_t PatternLength)
+{
+	//'*' matches any sequence of characters, '?' any single character. On a mismatch the
+	//last '*' is retried one character further, so no recursion or allocation is needed.
+	size_t a = 0;
+	size_t p = 0;
+	size_t starPattern = string::npos;
+	size_t starAddress = 0;
+
+	while (a < AddressLength)
+	{
+		if (p < PatternLength && (Pattern[p]=='?' || Pattern[p]==Address[a]))
+		{
+			a++;
+			p++;
+		}
+		else if (p < PatternLength && Pattern[p]=='*')
+		{
+			starPattern = p++;
+			starAddress = a;
+		}
+		else if (starPattern != string::npos)
+		{
+			p = starPattern+1;
+			a = ++starAddress;
+		}
+		else
+			return false;
+	}
+
+	while (p < PatternLength && Pattern[p]=='*')
+		p++;
+
+	return p == PatternLength;
+}
@@ -0,0 +1,73 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+//The receiver addresses compiled for dispatching, per port: literal addresses are looked up by
+//hash, addresses containing wildcards ('*' and '?') are matched against precompiled patterns.
+//The table is rebuilt whenever the set of receivers changes; lookups don't allocate.
+class OscDispatchTable
+{
+public:
+	OscDispatchTable();
+	~OscDispatchTable();
+
+	void clear();
+	void add(int Port, const String& Address, int ReceiverIndex);
+
+	//Appends the indices of the receivers on Port whose address matches Address, in ascending order
+	void match(int Port, const char* Address, vector<int>& Matches) const;
+
+	int getNumberOfReceivers() const {return numberOfReceivers;};
+
+	//Held while the table is rebuilt or a message is dispatched
+	CriticalSection& getLock() {return cs;};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	struct Literal
+	{
+		string address;
+		int receiverIndex;
+	};
+
+	struct Pattern
+	{
+		string pattern;
+		size_t prefixLength; //the characters before the first wildcard
+		int receiverIndex;
+	};
+
+	struct PortTable
+	{
+		unordered_map<unsigned int, vector<Literal> > literals; //by address hash
+		vector<Pattern> patterns;
+	};
+
+	unordered_map<int, PortTable> ports;
+	int numberOfReceivers;
+
+	CriticalSection cs;
+
+	static unsigned int hash(const char* Address, size_t Length);
+	static bool matchesWildcard(const char* Address, size_t AddressLength, const char* Pattern, size_t PatternLength);
+};
@@ -13,6 +13,9 @@
 
 
 #include "OscInputConfigurator.h"
+#include "SharedMemoryRing.h"
+#include "SlipTcp.h"
+#include "ReceiverQueue.h"
 
 OscInputConfigurator::OscInputConfigurator ()
     : addressLabel (0),
@@ -21,6 +24,10 @@ OscInputConfigurator::OscInputConfigurator ()
       portEditor (0),
       parameterslabel (0),
       parametersEditor (0),
+	  queueLabel (0),
+	  queueComboBox (0),
+	  queueSizeEditor (0),
+	  droppedLabel (0),
       okButton (0),
       cancelButton (0)
 {
@@ -75,6 +82,28 @@ OscInputConfigurator::OscInputConfigurator ()
     parametersEditor->setPopupMenuEnabled (true);
     parametersEditor->setText ("1");
 
+	addAndMakeVisible (queueLabel = new Label (T("queue"),
+                                               T("Queue:")));
+	queueLabel->setFont (Font (15.0000f, Font::plain));
+	queueLabel->setJustificationType (Justification::centredLeft);
+	queueLabel->setEditable (false, false, false);
+
+	addAndMakeVisible (queueComboBox = new ComboBox (T("queue")));
+	queueComboBox->addItem (T("Every message"), QUEUE_ALL + 1);
+	queueComboBox->addItem (T("Latest value"), QUEUE_LATEST + 1);
+	queueComboBox->addItem (T("Bounded, drop oldest"), QUEUE_BOUNDED + 1);
+	queueComboBox->setSelectedId (QUEUE_ALL + 1, true);
+
+	addAndMakeVisible (queueSizeEditor = new TextEditor (String::empty));
+	queueSizeEditor->setMultiLine (false);
+	queueSizeEditor->setReturnKeyStartsNewLine (false);
+	queueSizeEditor->setText ("16");
+
+	addAndMakeVisible (droppedLabel = new Label (T("dropped"), String::empty));
+	droppedLabel->setFont (Font (15.0000f, Font::plain));
+	droppedLabel->setJustificationType (Justification::centredLeft);
+	droppedLabel->setEditable (false, false, false);
+
     addAndMakeVisible (okButton = new TextButton (String::empty));
     okButton->setButtonText (T("Accept"));
     okButton->addListener (this);
@@ -89,7 +118,7 @@ OscInputConfigurator::OscInputConfigurator ()
     //[UserPreSize]
     //[/UserPreSize]
 
-    setSize (400, 105);
+    setSize (400, 137);
 
     //[Constructor] You can add your own custom stuff here..
     //[/Constructor]
@@ -108,6 +137,10 @@ OscInputConfigurator::~OscInputConfigurator()
     deleteAndZero (portEditor);
     deleteAndZero (parameterslabel);
     deleteAndZero (parametersEditor);
+	deleteAndZero (queueLabel);
+	deleteAndZero (queueComboBox);
+	deleteAndZero (queueSizeEditor);
+	deleteAndZero (droppedLabel);
     deleteAndZero (okButton);
     deleteAndZero (cancelButton);
 
@@ -135,6 +168,10 @@ void OscInputConfigurator::resized()
     portEditor->setBounds (56, 40, 168, 24);
     parameterslabel->setBounds (8, 72, 160, 24);
     parametersEditor->setBounds (168, 72, 56, 24);
+	queueLabel->setBounds (0, 104, 56, 24);
+	queueComboBox->setBounds (56, 104, 168, 24);
+	queueSizeEditor->setBounds (240, 104, 48, 24);
+	droppedLabel->setBounds (296, 104, 96, 24);
     okButton->setBounds (240, 40, 150, 24);
     cancelButton->setBounds (240, 72, 150, 24);
     //[UserResized] Add your own custom resize handling here..
@@ -162,7 +199,33 @@ String OscInputConfigurator::getAddress()
 	
 int OscInputConfigurator::getPort()
 {
-	return portEditor->getText().getIntValue();
+	if (getTcp())
+		return TcpSender::getTcpName(portEditor->getText()).getIntValue();
+	else if (getGroup().isNotEmpty())
+		return portEditor->getText().fromLastOccurrenceOf(":", false, false).getIntValue();
+	else
+		return portEditor->getText().getIntValue();
+}
+
+String OscInputConfigurator::getRing() //the port editor also takes "shm://name"
+{
+	if (SharedMemoryRing::isRingAddress(portEditor->getText()))
+		return SharedMemoryRing::getRingName(portEditor->getText());
+	else
+		return String::empty;
+}
+
+bool OscInputConfigurator::getTcp() //the port editor also takes "tcp://port"
+{
+	return TcpSender::isTcpAddress(portEditor->getText());
+}
+
+String OscInputConfigurator::getGroup() //the port editor also takes "group:port"
+{
+	if (getTcp() || SharedMemoryRing::isRingAddress(portEditor->getText()) || !portEditor->getText().containsChar(':'))
+		return String::empty;
+	else
+		return portEditor->getText().upToFirstOccurrenceOf(":", false, false).trim();
 }
 	
 int OscInputConfigurator::getNumberOfParameters()
@@ -180,6 +243,45 @@ void OscInputConfigurator::setPort(int Port)
 	portEditor->setText(String(Port));
 }
 
+void OscInputConfigurator::setRing(String Ring)
+{
+	if (Ring.isNotEmpty())
+		portEditor->setText("shm://" + Ring);
+}
+
+void OscInputConfigurator::setTcp(bool Tcp)
+{
+	if (Tcp)
+		portEditor->setText("tcp://" + portEditor->getText());
+}
+
+int OscInputConfigurator::getQueuePolicy()
+{
+	return queueComboBox->getSelectedId() - 1;
+}
+
+int OscInputConfigurator::getQueueSize() //only used by bounded queues
+{
+	return jmax(1, queueSizeEditor->getText().getIntValue());
+}
+
+void OscInputConfigurator::setQueuePolicy(int Policy, int Size)
+{
+	queueComboBox->setSelectedId(Policy + 1, true);
+	queueSizeEditor->setText(String(Size));
+}
+
+void OscInputConfigurator::setNumberOfDroppedMessages(int Number)
+{
+	droppedLabel->setText("Dropped: " + String(Number), false);
+}
+
+void OscInputConfigurator::setGroup(String Group)
+{
+	if (Group.isNotEmpty())
+		portEditor->setText(Group + ":" + portEditor->getText());
+}
+
 void OscInputConfigurator::setNumberOfParameters(int NumberOfParameters)
 {
 	parametersEditor->setText(String(NumberOfParameters));
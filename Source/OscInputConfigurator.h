@@ -34,11 +34,21 @@ public:
 
 	String getAddress();
 	int getPort();
+	String getRing();
+	bool getTcp();
+	String getGroup();
+	int getQueuePolicy();
+	int getQueueSize();
 	int getNumberOfParameters();
 	bool okClicked;
 
 	void setAddress(String Address);
 	void setPort(int Port);
+	void setRing(String Ring);
+	void setTcp(bool Tcp);
+	void setGroup(String Group);
+	void setQueuePolicy(int Policy, int Size);
+	void setNumberOfDroppedMessages(int Number);
 	void setNumberOfParameters(int NumberOfParameters);
 
 
@@ -56,6 +66,10 @@ private:
     TextEditor* portEditor;
     Label* parameterslabel;
     TextEditor* parametersEditor;
+	Label* queueLabel;
+	ComboBox* queueComboBox;
+	TextEditor* queueSizeEditor;
+	Label* droppedLabel;
     TextButton* okButton;
     TextButton* cancelButton;
 
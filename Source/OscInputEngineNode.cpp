@@ -0,0 +1,71 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "OscInputEngineNode.h"
+
+OscInputEngineNode::OscInputEngineNode()
+{
+	type=INPUTNODE;
+	address="/address";
+	port=3333;
+	tcp=false;
+	queuePolicy=QUEUE_ALL;
+	queueSize=16;
+}
+
+OscInputEngineNode::~OscInputEngineNode()
+{
+
+}
+
+void OscInputEngineNode::readXml(const XmlElement& NodeElement)
+{
+	EngineNode::readXml(NodeElement);
+
+	address = NodeElement.getStringAttribute("address");
+	port = NodeElement.getIntAttribute("port");
+	ring = NodeElement.getStringAttribute("ring");
+	group = NodeElement.getStringAttribute("group");
+	tcp = NodeElement.getBoolAttribute("tcp", false);
+	queuePolicy = NodeElement.getIntAttribute("queue", QUEUE_ALL);
+	queueSize = NodeElement.getIntAttribute("queueSize", 16);
+
+	int numberOfOutputs=0;
+	forEachXmlChildElementWithTagName (NodeElement, e, "Output")
+		numberOfOutputs++;
+
+	setNumberOfOutputs(numberOfOutputs);
+}
+
+void OscInputEngineNode::writeXml(XmlElement& NodeElement)
+{
+	EngineNode::writeXml(NodeElement);
+
+	NodeElement.setAttribute("address", address);
+	NodeElement.setAttribute("port", port);
+	if (ring.isNotEmpty())
+		NodeElement.setAttribute("ring", ring);
+	if (group.isNotEmpty())
+		NodeElement.setAttribute("group", group);
+	if (tcp)
+		NodeElement.setAttribute("tcp", true);
+	if (queuePolicy != QUEUE_ALL)
+	{
+		NodeElement.setAttribute("queue", queuePolicy);
+		NodeElement.setAttribute("queueSize", queueSize);
+	}
+
+	for (int i=0; i<getNumberOfOutputs(); i++)
+		NodeElement.createNewChildElement("Output");
+}
@@ -0,0 +1,54 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "EngineNode.h"
+#include "ReceiverQueue.h"
+
+class OscInputEngineNode : public EngineNode
+{
+public:
+	OscInputEngineNode();
+	~OscInputEngineNode();
+
+	String getAddress() {return address;};
+	int getPort() {return port;};
+	void setAddress(String Address) {address=Address;};
+	void setPort(int Port) {port=Port;};
+	String getRing() {return ring;};
+	void setRing(String Ring) {ring=Ring;}; //empty to receive on the port
+	String getGroup() {return group;};
+	void setGroup(String Group) {group=Group;}; //multicast group joined on the port, empty for none
+	int getQueuePolicy() {return queuePolicy;};
+	int getQueueSize() {return queueSize;};
+	void setQueuePolicy(int Policy, int Size) {queuePolicy=Policy; queueSize=Size;}; //see ReceiverQueue
+	bool isTcp() {return tcp;};
+	void setTcp(bool Tcp) {tcp=Tcp;}; //receive on the TCP port instead of the UDP port
+
+	void readXml(const XmlElement& NodeElement);
+	void writeXml(XmlElement& NodeElement);
+
+	juce_UseDebuggingNewOperator
+
+private:
+	String address;
+	int port;
+	String ring;
+	String group;
+	bool tcp;
+	int queuePolicy;
+	int queueSize;
+};
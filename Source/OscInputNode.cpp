@@ -15,15 +15,16 @@
 #include "OscInputNode.h"
 #include "MainComponent.h"
 
-OscInputNode::OscInputNode ()
+OscInputNode::OscInputNode (OscInputEngineNode* theEngineNode)
 {
 	title->setText("Osc input", false);
 	title->addMouseListener(title->getParentComponent(), false);
 
 	oscManager=0;
 	type=INPUTNODE;
-	address="/address";
-	port=3333;
+	engineNode=theEngineNode;
+
+	createConnectors(0, engineNode->getNumberOfOutputs());
 }
 
 OscInputNode::~OscInputNode()
@@ -38,44 +39,52 @@ void OscInputNode::mouseDoubleClick(const MouseEvent &e)
 		OscInputConfigurator* configurator = new OscInputConfigurator();
 		configurator->setAddress(getAddress());
 		configurator->setPort(getPort());
+		configurator->setGroup(getGroup());
+		configurator->setTcp(isTcp());
+		configurator->setRing(getRing());
 		configurator->setNumberOfParameters(getNumberOfOutputs());
+		configurator->setQueuePolicy(getInputEngineNode()->getQueuePolicy(), getInputEngineNode()->getQueueSize());
+		configurator->setNumberOfDroppedMessages(oscManager->getNumberOfDroppedMessages(engineNode));
 
 		DialogWindow::showModalDialog(title->getText()+" configuration", configurator, this, Colours::lightgrey, false);
 
 		if (configurator->okClicked)
 		{
+			//The queue is sized for the values of the node
+			bool queueChanged = configurator->getNumberOfParameters() != getNumberOfOutputs() ||
+				configurator->getQueuePolicy() != getInputEngineNode()->getQueuePolicy() ||
+				configurator->getQueueSize() != getInputEngineNode()->getQueueSize();
+
 			if (configurator->getNumberOfParameters() != getNumberOfOutputs())
 			{
-				((MainComponent*)e.eventComponent->getParentComponent())->deleteConnectionsOfNode((Node*)e.eventComponent);
-
-				for (unsigned int i=0; i<outputConnectors.size(); i++)
-					deleteAndZero(outputConnectors[i]);
-				outputConnectors.clear();
-
-				for (int i=0; i<configurator->getNumberOfParameters(); i++)
-				{
-					OutputConnector* outputConnector = new OutputConnector();
-					outputConnector->setID(i);
-					addAndMakeVisible(outputConnector);
-					outputConnectors.push_back(outputConnector);
-				}
-
-				if (outputConnectors.size()==0)
-				{
-					setSize(100, 40);
-				}
-				else
-					setSize(100, 20+outputConnectors.size()*20);
+				MainComponent* mainComponent = (MainComponent*)e.eventComponent->getParentComponent();
+				mainComponent->deleteConnectionsOfNode((Node*)e.eventComponent);
+
+				const ScopedLock myScopedLock (mainComponent->engine.getLock());
+
+				engineNode->setNumberOfOutputs(configurator->getNumberOfParameters());
+				createConnectors(0, configurator->getNumberOfParameters());
 			}
 
-			if (configurator->getAddress() != getAddress() || configurator->getPort() != getPort())
+			if (configurator->getAddress() != getAddress() || configurator->getPort() != getPort() || configurator->getRing() != getRing() || configurator->getTcp() != isTcp() || configurator->getGroup() != getGroup())
 			{
-				oscManager->unregisterReceiver(this);
+				oscManager->unregisterReceiver(engineNode);
 
 				//Register the osc address
-				address = configurator->getAddress();
-				port = configurator->getPort();
-				oscManager->registerReceiver(address, configurator->getNumberOfParameters(), port, this);
+				getInputEngineNode()->setAddress(configurator->getAddress());
+				getInputEngineNode()->setRing(configurator->getRing());
+				getInputEngineNode()->setTcp(configurator->getTcp());
+				getInputEngineNode()->setGroup(configurator->getGroup());
+				if (configurator->getRing().isEmpty())
+					getInputEngineNode()->setPort(configurator->getPort());
+				oscManager->registerReceiver(getAddress(), configurator->getNumberOfParameters(), getPort(), getGroup(), isTcp(), getRing(), engineNode);
+				queueChanged = true;
+			}
+
+			if (queueChanged)
+			{
+				getInputEngineNode()->setQueuePolicy(configurator->getQueuePolicy(), configurator->getQueueSize());
+				oscManager->setQueuePolicy(engineNode, getInputEngineNode()->getQueuePolicy(), getInputEngineNode()->getQueueSize());
 			}
 
 			resized();
@@ -18,28 +18,29 @@
 #include "Node.h"
 #include "OscInputConfigurator.h"
 #include "OscManager.h"
+#include "OscInputEngineNode.h"
 
 class OscInputNode  : public Node
 {
 public:
     //==============================================================================
-    OscInputNode ();
+    OscInputNode (OscInputEngineNode* theEngineNode);
     ~OscInputNode();
 
 	void setOscManager(OscManager* theOscManager) {oscManager=theOscManager;};
 
 	void mouseDoubleClick(const MouseEvent &e);
 
-	String getAddress() {return address;};
-	int getPort() {return port;};
-	void setAddress(String Address) {address=Address;};
-	void setPort(int Port) {port=Port;};
+	String getAddress() {return getInputEngineNode()->getAddress();};
+	int getPort() {return getInputEngineNode()->getPort();};
+	String getRing() {return getInputEngineNode()->getRing();};
+	bool isTcp() {return getInputEngineNode()->isTcp();};
+	String getGroup() {return getInputEngineNode()->getGroup();};
+	OscInputEngineNode* getInputEngineNode() {return (OscInputEngineNode*)engineNode;};
 
     //==============================================================================
     juce_UseDebuggingNewOperator
 
 private:
 	OscManager* oscManager;
-	String address;
-	int port;
 };
@@ -13,280 +13,1180 @@
 
 
 #include "OscManager.h"
-#include "MainComponent.h"
+#include "Engine.h"
+#include "Pool.h"
 
 OscManager::OscManager() : Thread("OscManager")
 {
-	 mainComponent=0;
+	 engine=0;
+	 bundleFrames=true;
+	 honourTimeTags=false;
+	 statisticsQueries=false;
+	 lastStatisticsReply=0;
+	 outputTimeTag=1;
+	 numberOfReceiveThreads=1;
+	 numberOfSocketsPerPort=1;
+	 openSocketsPerPort=1;
+	 multicastTtl=1;
+	 socketsChanged=true;
+	 numberOfQueuedReceivers=0;
 	 Pool::Instance()->reg("OscManager", this);
 }
 
 OscManager::~OscManager()
 {
-	
+	for (unsigned int i=0; i<receivers.size(); i++)
+		delete receivers[i].queue;
 }
 
-void OscManager::setMainComponent(MainComponent *theMainComponent)
+void OscManager::setEngine(Engine *theEngine)
 {
-	mainComponent = theMainComponent;
+	engine = theEngine;
 }
 
-void OscManager::registerReceiver(String Address, int NumberOfParameters, int Port, Node* ReceiverNode)
+void OscManager::registerReceiver(String Address, int NumberOfParameters, int Port, String Group, bool Tcp, String Ring, EngineNode* ReceiverNode)
 {
-	cs.enter();
+	const ScopedLock myScopedLock (cs);
 
 	ReceiverRegistration receiver;
 	receiver.address=Address;
 	receiver.numberOfParameters=NumberOfParameters;
 	receiver.port=Port;
+	receiver.group=Group;
+	receiver.tcp=Tcp;
+	receiver.ring=Ring;
+	receiver.dispatchPort=Tcp ? TCP_DISPATCH_OFFSET + Port : Port;
 	receiver.receiverNode=ReceiverNode;
+	receiver.queue=0;
+
+	if (Ring.isNotEmpty())
+	{
+		int index = ringNames.indexOf(Ring);
+		if (index == -1)
+		{
+			ringNames.add(Ring);
+			index = ringNames.size()-1;
+		}
+		receiver.dispatchPort = -(index+1);
+	}
 	receiver.remoteAdding=false;
 	receiver.remoteClearing=false;
 
+	const ScopedLock dispatchLock (dispatchTable.getLock());
+
 	receivers.push_back(receiver);
-	
-	cs.exit();
+	rebuildDispatchTable();
+
+	socketsChanged = true;
+	notify();
 }
 
-void OscManager::unregisterReceiver(Node* ReceiverNode)
+void OscManager::unregisterReceiver(EngineNode* ReceiverNode)
 {
-	cs.enter();
+	const ScopedLock myScopedLock (cs);
+	const ScopedLock dispatchLock (dispatchTable.getLock());
 
 	for (int i=0; i<receivers.size(); i++)
 		if (receivers[i].receiverNode==ReceiverNode)
 		{
+			if (receivers[i].queue)
+			{
+				delete receivers[i].queue;
+				numberOfQueuedReceivers--;
+			}
+
 			receivers.erase(receivers.begin()+i);
-			cs.exit();
+			rebuildDispatchTable();
+
+			socketsChanged = true;
+			notify();
 			return;
 		}
+}
+
+void OscManager::rebuildDispatchTable() //Called with the dispatch lock held
+{
+	dispatchTable.clear();
+
+	for (unsigned int i=0; i<receivers.size(); i++)
+		dispatchTable.add(receivers[i].dispatchPort, receivers[i].address, i);
+}
+
+void OscManager::setNumberOfReceiveThreads(int Number)
+{
+	if (Number < 1)
+		Number = 1;
+
+	const ScopedLock myScopedLock (cs);
+
+	numberOfReceiveThreads = Number;
+	socketsChanged = true;
+	notify();
+}
+
+void OscManager::setNumberOfSocketsPerPort(int Number)
+{
+#ifndef OSC_SOCKET_REUSE_BALANCES
+	Number = 1;
+#endif
+	if (Number < 1)
+		Number = 1;
+
+	const ScopedLock myScopedLock (cs);
 
-	cs.exit();
+	numberOfSocketsPerPort = Number;
+	socketsChanged = true;
+	notify();
+}
+
+void OscManager::setStatisticsQueries(bool Enabled, const String& AllowedHosts)
+{
+	StringArray hosts;
+	hosts.addTokens(AllowedHosts, ",", String::empty);
+	hosts.trim();
+	hosts.removeEmptyStrings();
+
+	//Resolved before taking the lock
+	vector<unsigned long> allowed;
+	for (int i=0; i<hosts.size(); i++)
+	{
+		unsigned long address = IpEndpointName(hosts[i].toCString()).address;
+		if (address != 0)
+			allowed.push_back(address);
+		else
+			Logger::writeToLog("OscCalibrator: unable to resolve the statistics host " + hosts[i]);
+	}
+
+	const ScopedLock myScopedLock (cs);
+
+	statisticsQueries = Enabled;
+	statisticsAllowedHosts = AllowedHosts;
+	statisticsAllowed.swap(allowed);
+}
+
+bool OscManager::acceptStatisticsQuery(const IpEndpointName& From)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (!statisticsQueries)
+		return false;
+
+	if ((From.address >> 24) != 127 && find(statisticsAllowed.begin(), statisticsAllowed.end(), From.address) == statisticsAllowed.end())
+		return false;
+
+	uint32 now = Time::getMillisecondCounter();
+	if (lastStatisticsReply != 0 && now - lastStatisticsReply < STATS_INTERVAL)
+		return false;
+
+	lastStatisticsReply = jmax((uint32)1, now);
+	return true;
+}
+
+void OscManager::setMulticastOptions(int Ttl, const String& Interface)
+{
+	const ScopedLock myScopedLock (cs);
+
+	multicastTtl = Ttl;
+	multicastInterface = Interface;
+
+	for (unsigned int i=0; i<destinations.size(); i++)
+		destinations[i]->setMulticastOptions(multicastTtl, multicastInterface);
+
+	//The groups are joined again on the new interface
+	socketsChanged = true;
+	notify();
+}
+
+void OscManager::setQueuePolicy(EngineNode* ReceiverNode, int Policy, int Capacity)
+{
+	const ScopedLock myScopedLock (cs);
+	const ScopedLock dispatchLock (dispatchTable.getLock());
+
+	for (unsigned int i=0; i<receivers.size(); i++)
+		if (receivers[i].receiverNode==ReceiverNode)
+		{
+			if (receivers[i].queue)
+			{
+				delete receivers[i].queue;
+				receivers[i].queue = 0;
+				numberOfQueuedReceivers--;
+			}
+
+			if (Policy != QUEUE_ALL)
+			{
+				receivers[i].queue = new ReceiverQueue(Policy, Capacity, ReceiverNode->getNumberOfOutputs());
+				numberOfQueuedReceivers++;
+			}
+		}
+}
+
+int OscManager::getNumberOfDroppedMessages(EngineNode* ReceiverNode)
+{
+	const ScopedLock myScopedLock (cs);
+
+	for (unsigned int i=0; i<receivers.size(); i++)
+		if (receivers[i].receiverNode==ReceiverNode && receivers[i].queue)
+			return receivers[i].queue->getNumberOfDropped();
+
+	return 0;
+}
+
+void OscManager::processQueues()
+{
+	if (numberOfQueuedReceivers == 0 || engine == 0)
+		return;
+
+	//Each pass evaluates the oldest pending values of every queue, until all are empty. The
+	//engine lock is released in between, so other receivers aren't held up by a long backlog.
+	bool haveToProcess = true;
+	while (haveToProcess && !threadShouldExit())
+	{
+		bool haveToAddCalibrationPoint = false;
+		bool haveToClearCalibration = false;
+		haveToProcess = false;
+
+		{
+			const ScopedLock engineLock (engine->getLock());
+
+			{
+				const ScopedLock myScopedLock (cs);
+
+				for (unsigned int i=0; i<receivers.size(); i++)
+				{
+					ReceiverRegistration& receiver = receivers[i];
+
+					int64 receiveTicks;
+
+					if (receiver.queue == 0 || !receiver.queue->pop(receiver.receiverNode->getOutputValues(), receiver.receiverNode->getNumberOfOutputs(), receiveTicks))
+						continue;
+
+					receiver.receiverNode->markUpdated();
+					receiver.receiverNode->setReceiveTicks(receiveTicks);
+
+					if (receiver.remoteAdding)
+						haveToAddCalibrationPoint = true;
+
+					if (receiver.remoteClearing)
+						haveToClearCalibration = true;
+
+					haveToProcess = true;
+				}
+			}
+
+			if (haveToProcess)
+				engine->process();
+		}
+
+		triggerRemoteActions(haveToAddCalibrationPoint, haveToClearCalibration);
+	}
 }
 
 void OscManager::run()
 {
+	TraceThread traceThread;
+
+	bundleScheduler.startThread();
+
 	while (!threadShouldExit())
 	{
-		//Update Sockets: Check if new sockets are needed
+		//Sockets are opened and closed when receivers are registered or unregistered
+		if (socketsChanged)
+			updateSockets();
+
+		//Queued values are evaluated here, woken up by the receiving threads
+		processQueues();
+
+		//Calibrators waiting for their inputs are evaluated once their join timeout has passed
+		if (engine)
+			engine->processExpiredJoins();
+
+		wait(10);
+	}
+}
+
+void OscManager::updateSockets()
+{
+	vector<int> ports;
+	vector<StringArray> portGroups; //the multicast groups of each port
+	String groupInterface;
+	vector<int> tcpPorts;
+	StringArray rings;
+	vector<int> ringPorts;
+	int threads;
+	int socketsPerPort;
+
+	{
+		const ScopedLock myScopedLock (cs);
+
+		socketsChanged = false;
+
 		for (unsigned int i=0; i<receivers.size(); i++)
 		{
-			bool found=false;
-
-			for (unsigned int j=0; j<sockets.size(); j++)
+			if (receivers[i].ring.isNotEmpty())
 			{
-				if (sockets[j]->getPort()==receivers[i].port)
-					found=true;
+				if (!rings.contains(receivers[i].ring))
+				{
+					rings.add(receivers[i].ring);
+					ringPorts.push_back(receivers[i].dispatchPort);
+				}
 			}
-
-			if (!found)
+			else if (receivers[i].tcp)
 			{
-				SocketThread* st = new SocketThread(&receivers, receivers[i].port, mainComponent);
-				if (st)
+				if (find(tcpPorts.begin(), tcpPorts.end(), receivers[i].port) == tcpPorts.end())
+					tcpPorts.push_back(receivers[i].port);
+			}
+			else
+			{
+				int index = (int)(find(ports.begin(), ports.end(), receivers[i].port) - ports.begin());
+				if (index == (int)ports.size())
 				{
-					sockets.push_back(st);
-					st->startThread();
+					ports.push_back(receivers[i].port);
+					portGroups.push_back(StringArray());
 				}
+
+				if (receivers[i].group.isNotEmpty())
+					portGroups[index].addIfNotAlreadyThere(receivers[i].group);
 			}
 		}
 
-		//Update Sockets: Remove not needed sockets
-		cs.enter();
+		groupInterface = multicastInterface;
+
+		socketsPerPort = numberOfSocketsPerPort;
+		threads = jmax(numberOfReceiveThreads, socketsPerPort);
+	}
+
+	//A changed number of threads or sockets per port redistributes all ports
+	if ((int)receiveThreads.size() != threads || openSocketsPerPort != socketsPerPort)
+	{
+		closeSockets();
+		openSocketsPerPort = socketsPerPort;
+
+		for (int i=0; i<threads; i++)
+		{
+			ReceiveThread* receiveThread = new ReceiveThread();
+			receiveThreads.push_back(receiveThread);
+			receiveThread->startThread();
+		}
+	}
 
-		int j=0;
-		while (j<sockets.size())
+	//Close the sockets of ports that are no longer needed
+	unsigned int j=0;
+	while (j<listeners.size())
+	{
+		if (find(ports.begin(), ports.end(), listeners[j]->getPort()) == ports.end())
 		{
-			bool found=false;
+			for (unsigned int i=0; i<receiveThreads.size(); i++)
+				if (receiveThreads[i]->detach(listeners[j]))
+					break;
 
-			for (unsigned int i=0; i<receivers.size(); i++)
+			PortListener* listener = listeners[j];
 			{
-				if (sockets[j]->getPort()==receivers[i].port)
-					found=true;
+				const ScopedLock myScopedLock (listenersLock);
+				listeners.erase(listeners.begin()+j);
 			}
+			delete listener;
+		}
+		else
+			j++;
+	}
 
-			if (!found)
+	//Open sockets for new ports, each on the thread serving the fewest ports among those not
+	//serving the port yet
+	for (unsigned int i=0; i<ports.size(); i++)
+	{
+		int found=0;
+
+		for (unsigned int j=0; j<listeners.size(); j++)
+		{
+			if (listeners[j]->getPort()==ports[i])
+				found++;
+		}
+
+		for (; found<socketsPerPort; found++)
+		{
+			PortListener* listener;
+
+			listener = new PortListener(&receivers, &dispatchTable, ports[i], engine);
+
+			try
 			{
-				sockets[j]->Break();
-				sockets[j]->stopThread(100);
-				delete sockets[j];
-				sockets.erase(sockets.begin()+j);
+				listener->open(socketsPerPort > 1);
 			}
-			else
-				j++;
+			catch (std::runtime_error&)
+			{
+				//Tried again with the next change of the receivers
+				Logger::writeToLog("OscCalibrator: unable to receive on port " + String(ports[i]));
+				delete listener;
+				break;
+			}
+
+			ReceiveThread* receiveThread = 0;
+			for (unsigned int k=0; k<receiveThreads.size(); k++)
+			{
+				if (receiveThreads[k]->servesPort(ports[i]))
+					continue;
+
+				if (receiveThread == 0 || receiveThreads[k]->getNumberOfPorts() < receiveThread->getNumberOfPorts())
+					receiveThread = receiveThreads[k];
+			}
+
+			try
+			{
+				receiveThread->attach(listener);
+			}
+			catch (std::runtime_error&)
+			{
+				//Tried again with the next change of the receivers
+				Logger::writeToLog("OscCalibrator: unable to wait for packets on port " + String(ports[i]));
+				delete listener;
+				break;
+			}
+
+			const ScopedLock myScopedLock (listenersLock);
+			listeners.push_back(listener);
+		}
+
+		//The first socket of the port joins its groups, the others only receive unicast
+		for (unsigned int j=0; j<listeners.size(); j++)
+		{
+			if (listeners[j]->getPort()==ports[i])
+			{
+				listeners[j]->setGroups(portGroups[i], groupInterface);
+				break;
+			}
+		}
+	}
+
+	//Shared memory rings are polled by a thread each
+	j=0;
+	while (j<ringReceivers.size())
+	{
+		if (!rings.contains(ringReceivers[j]->getName()))
+		{
+			delete ringReceivers[j];
+			ringReceivers.erase(ringReceivers.begin()+j);
+		}
+		else
+			j++;
+	}
+
+	for (int i=0; i<rings.size(); i++)
+	{
+		bool found=false;
+
+		for (unsigned int j=0; j<ringReceivers.size(); j++)
+		{
+			if (ringReceivers[j]->getName()==rings[i])
+				found=true;
+		}
+
+		if (!found)
+		{
+			RingReceiver* ringReceiver = new RingReceiver(rings[i], new PortListener(&receivers, &dispatchTable, ringPorts[i], engine));
+
+			if (!ringReceiver->open())
+			{
+				Logger::writeToLog("OscCalibrator: unable to open the shared memory ring " + rings[i]);
+				delete ringReceiver;
+				continue;
+			}
+
+			ringReceiver->startThread();
+			ringReceivers.push_back(ringReceiver);
+		}
+	}
+
+	//TCP ports accept connections on a thread each, which reads them on a thread each
+	j=0;
+	while (j<tcpReceivers.size())
+	{
+		if (find(tcpPorts.begin(), tcpPorts.end(), tcpReceivers[j]->getPort()) == tcpPorts.end())
+		{
+			delete tcpReceivers[j];
+			tcpReceivers.erase(tcpReceivers.begin()+j);
+		}
+		else
+			j++;
+	}
+
+	for (unsigned int i=0; i<tcpPorts.size(); i++)
+	{
+		bool found=false;
+
+		for (unsigned int j=0; j<tcpReceivers.size(); j++)
+		{
+			if (tcpReceivers[j]->getPort()==tcpPorts[i])
+				found=true;
 		}
 
-		cs.exit();
+		if (!found)
+		{
+			TcpReceiver* tcpReceiver = new TcpReceiver(tcpPorts[i], new PortListener(&receivers, &dispatchTable, TCP_DISPATCH_OFFSET + tcpPorts[i], engine));
 
-		sleep(10);
+			if (!tcpReceiver->open())
+			{
+				Logger::writeToLog("OscCalibrator: unable to receive on tcp port " + String(tcpPorts[i]));
+				delete tcpReceiver;
+				continue;
+			}
+
+			tcpReceiver->startThread();
+			tcpReceivers.push_back(tcpReceiver);
+		}
 	}
 }
 
-void OscManager::stop()
+void OscManager::closeSockets()
 {
-	cs.enter();
+	for (unsigned int i=0; i<receiveThreads.size(); i++)
+	{
+		receiveThreads[i]->stop();
+		delete receiveThreads[i];
+	}
+	receiveThreads.clear();
 
-	for (unsigned int i=0; i<sockets.size(); i++)
+	vector<PortListener*> closed;
 	{
-		sockets[i]->Break();
-		sockets[i]->stopThread(100);
-		delete sockets[i];
+		const ScopedLock myScopedLock (listenersLock);
+		closed.swap(listeners);
 	}
-	sockets.clear();
+	for (unsigned int i=0; i<closed.size(); i++)
+		delete closed[i];
 
-	cs.exit();
+	for (unsigned int i=0; i<ringReceivers.size(); i++)
+		delete ringReceivers[i];
+	ringReceivers.clear();
 
+	for (unsigned int i=0; i<tcpReceivers.size(); i++)
+		delete tcpReceivers[i];
+	tcpReceivers.clear();
+}
+
+void OscManager::stop()
+{
 	stopThread(500);
+	bundleScheduler.stopThread(500);
+
+	closeSockets();
+	socketsChanged = true;
 }
 
-SocketThread::SocketThread(vector<ReceiverRegistration> *Receivers, int Port, MainComponent* theMainComponent) : Thread("SocketThread")
+PortListener::PortListener(vector<ReceiverRegistration> *Receivers, OscDispatchTable* DispatchTable, int Port, Engine* theEngine)
 {
 	port = Port;
 	receivers=Receivers;
-	s = new UdpListeningReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, Port), this);
+	dispatchTable=DispatchTable;
+	s = 0;
+	numberOfPackets = 0;
 
-	mainComponent=theMainComponent;
+	engine=theEngine;
 }
 	
-SocketThread::~SocketThread()
+PortListener::~PortListener()
 {
+	engine->oscManager.getBundleScheduler().cancel(this);
+
 	delete s;
 }
 
-int SocketThread::getPort()
+void PortListener::open(bool Shared)
+{
+	s = new UdpSocket();
+
+	try
+	{
+		if (Shared)
+			s->SetAllowReuse(true);
+
+		s->SetReceiveJoinedGroupsOnly(true);
+		s->SetReceiveTimestamps(true);
+
+		s->Bind(IpEndpointName(IpEndpointName::ANY_ADDRESS, port));
+	}
+	catch (std::runtime_error&)
+	{
+		delete s;
+		s = 0;
+		throw;
+	}
+}
+
+void PortListener::setGroups(const StringArray& Groups, const String& Interface)
+{
+	if (Interface != groupInterface)
+	{
+		for (int i=0; i<groups.size(); i++)
+		{
+			try
+			{
+				s->LeaveMulticastGroup(IpEndpointName(groups[i].toCString()).address, OscDestination::resolveInterface(groupInterface));
+			}
+			catch (std::runtime_error&)
+			{
+			}
+		}
+
+		groups.clear();
+		groupInterface = Interface;
+	}
+
+	int i=0;
+	while (i<groups.size())
+	{
+		if (!Groups.contains(groups[i]))
+		{
+			try
+			{
+				s->LeaveMulticastGroup(IpEndpointName(groups[i].toCString()).address, OscDestination::resolveInterface(groupInterface));
+			}
+			catch (std::runtime_error&)
+			{
+			}
+
+			groups.remove(i);
+		}
+		else
+			i++;
+	}
+
+	for (int i=0; i<Groups.size(); i++)
+	{
+		if (groups.contains(Groups[i]))
+			continue;
+
+		try
+		{
+			s->JoinMulticastGroup(IpEndpointName(Groups[i].toCString()).address, OscDestination::resolveInterface(groupInterface));
+			groups.add(Groups[i]);
+		}
+		catch (std::runtime_error&)
+		{
+			//Tried again with the next change of the receivers
+			Logger::writeToLog("OscCalibrator: unable to join the multicast group " + Groups[i] + " on port " + String(port));
+		}
+	}
+}
+
+int PortListener::getPort()
 {
 	return port;
 }
 
-void SocketThread::run()
+RingReceiver::RingReceiver(const String& Name, PortListener* Listener) : Thread("RingReceiver")
+{
+	name = Name;
+	listener = Listener;
+}
+
+RingReceiver::~RingReceiver()
+{
+	stopThread(500);
+	delete listener;
+}
+
+bool RingReceiver::open()
 {
-	if (!threadShouldExit())
+	return ring.open(name);
+}
+
+void RingReceiver::run()
+{
+	TraceThread traceThread;
+
+	int idle = 0;
+
+	while (!threadShouldExit())
 	{
-		s->Run();
-		sleep(5);
+		int size;
+		const char* packet = ring.read(size);
+
+		if (packet == 0)
+		{
+			//Spins for a while after the last packet, then sleeps between polls
+			if (++idle < 1000)
+				Thread::yield();
+			else
+				Thread::sleep(1);
+
+			continue;
+		}
+
+		idle = 0;
+
+		try
+		{
+			listener->ProcessPacket(packet, size, IpEndpointName());
+		}
+		catch (osc::Exception&)
+		{
+			//Malformed packets are dropped
+		}
+
+		ring.release();
 	}
-	
 }
 
-void SocketThread::Break()
+ReceiveThread::ReceiveThread() : Thread("ReceiveThread")
+{
+}
+
+ReceiveThread::~ReceiveThread()
+{
+	stop();
+}
+
+void ReceiveThread::attach(PortListener* listener)
+{
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+	multiplexer.AttachSocketListener(listener->getSocket(), listener);
+#else
+	//Without epoll the multiplexer can only be changed while it isn't running
+	bool wasRunning = isThreadRunning();
+	if (wasRunning)
+		stop();
+
+	multiplexer.AttachSocketListener(listener->getSocket(), listener);
+
+	if (wasRunning)
+		startThread();
+#endif
+
+	listeners.push_back(listener);
+}
+
+bool ReceiveThread::servesPort(int Port)
+{
+	for (unsigned int i=0; i<listeners.size(); i++)
+		if (listeners[i]->getPort() == Port)
+			return true;
+
+	return false;
+}
+
+bool ReceiveThread::detach(PortListener* listener)
+{
+	vector<PortListener*>::iterator it = find(listeners.begin(), listeners.end(), listener);
+	if (it == listeners.end())
+		return false;
+
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+	multiplexer.DetachSocketListener(listener->getSocket(), listener);
+#else
+	bool wasRunning = isThreadRunning();
+	if (wasRunning)
+		stop();
+
+	multiplexer.DetachSocketListener(listener->getSocket(), listener);
+
+	if (wasRunning)
+		startThread();
+#endif
+
+	listeners.erase(it);
+	return true;
+}
+
+void ReceiveThread::run()
+{
+	TraceThread traceThread;
+
+	while (!threadShouldExit())
+		multiplexer.Run();
+}
+
+void ReceiveThread::stop()
 {
-	s->AsynchronousBreak();
+	signalThreadShouldExit();
+
+	//The break is repeated, as one that arrives just before the multiplexer starts running is lost
+	for (int i=0; i<50 && isThreadRunning(); i++)
+	{
+		multiplexer.AsynchronousBreak();
+		waitForThreadToExit(20);
+	}
+
+	stopThread(100);
 }
 
-void SocketThread::ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint)
+void PortListener::ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint)
 {
-	bool haveToProcess = false;
+	TraceScope trace("receive");
+	int64 receiveTicks = Time::getHighResolutionTicks();
+
+	//Only the datagrams of the socket; rings and TCP streams pass their packets in here as well
+	if (s != 0)
+	{
+		//Traced from the kernel timestamp where there is one, including the wait in the socket
+		numberOfPackets++;
+
+		//The kernel stamps with the wall clock, which may be stepped: a stamp after now counts as no wait
+		int64 delay = jmax((int64)0, LatencyHistogram::microsecondsToTicks((int64)(s->LastReceiveDelay() * 1000000)));
+		receiveTicks -= delay;
+
+		if (delay > 0 && TraceRecorder::isRecording())
+			TraceRecorder::addEvent("socket wait", receiveTicks, receiveTicks + delay, -1);
+
+		engine->oscManager.getCapture().record(port, remoteEndpoint, data, size);
+
+		//Compared with the padded address string, so other messages aren't parsed for it. Queries
+		//that aren't accepted are dropped without a reply.
+		if (size >= (int)sizeof(STATS_ADDRESS) && memcmp(data, STATS_ADDRESS, sizeof(STATS_ADDRESS)) == 0)
+		{
+			if (engine->oscManager.acceptStatisticsQuery(remoteEndpoint))
+				replyStatistics(remoteEndpoint);
+			return;
+		}
+	}
+
+	try
+	{
+		//Parsed here rather than by OscPacketListener, so the receive time is passed down with the
+		//packet: TCP connections call this concurrently on one listener
+		osc::ReceivedPacket p(data, size);
+		if (p.IsBundle())
+			receiveBundle(osc::ReceivedBundle(p), receiveTicks);
+		else
+			receiveMessage(osc::ReceivedMessage(p), receiveTicks);
+	}
+	catch (osc::Exception&)
+	{
+		//Malformed (or truncated) packets are dropped, so they don't stop the thread serving all ports
+	}
+}
+
+void PortListener::replyStatistics(const IpEndpointName& remoteEndpoint)
+{
+	try
+	{
+		engine->sendStatistics(s, remoteEndpoint);
+	}
+	catch (osc::Exception&)
+	{
+	}
+	catch (std::runtime_error&)
+	{
+		//Replies the network refuses are lost
+	}
+}
+
+void PortListener::ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint)
+{
+	receiveMessage(m, Time::getHighResolutionTicks());
+}
+
+void PortListener::ProcessBundle(const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint)
+{
+	receiveBundle(b, Time::getHighResolutionTicks());
+}
+
+void PortListener::receiveMessage(const osc::ReceivedMessage& m, int64 ReceiveTicks)
+{
+	TraceScope trace("dispatch");
+
+	//Queued receivers take their values without waiting for the engine lock
+	if (engine->oscManager.hasQueuedReceivers())
+	{
+		bool queued = false;
+		bool haveToApply = queueMessage(m, queued, ReceiveTicks);
+
+		if (queued)
+			engine->oscManager.notify();
+
+		if (!haveToApply)
+			return;
+	}
+
 	bool haveToAddCalibrationPoint = false;
 	bool haveToClearCalibration = false;
 
-	for (unsigned int i=0; i<receivers->size(); i++)
 	{
-		String recAddress = (*receivers)[i].address.trim();
-		String mesAddress = String(m.AddressPattern()).trim();
+		const ScopedLock myScopedLock (engine->getLock());
+
+		bool haveToProcess = applyMessage(m, haveToAddCalibrationPoint, haveToClearCalibration, ReceiveTicks);
+
+		if (haveToProcess)
+			engine->process();
+	}
+
+	engine->oscManager.triggerRemoteActions(haveToAddCalibrationPoint, haveToClearCalibration);
+}
 
-		if (mesAddress.matchesWildcard(recAddress, false))
+void PortListener::receiveBundle(const osc::ReceivedBundle& b, int64 ReceiveTicks)
+{
+	if (!engine->oscManager.getBundleFrames())
+	{
+		for (osc::ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i)
 		{
-			vector<float> arguments;
-			osc::ReceivedMessage::const_iterator arg = m.ArgumentsBegin();
-			for (long i=0; i<m.ArgumentCount(); i++)
-			{
-				arguments.push_back(arg->AsFloatUnchecked());
-				arg++;
-			}
+			if (i->IsBundle())
+				receiveBundle(osc::ReceivedBundle(*i), ReceiveTicks);
+			else
+				receiveMessage(osc::ReceivedMessage(*i), ReceiveTicks);
+		}
 
-			for (unsigned int j=0; j<(*receivers)[i].receiverNode->getNumberOfOutputs(); j++)
-			{
-				if (j<m.ArgumentCount())
-					(*receivers)[i].receiverNode->setOutputValue(j, arguments[j]);
-				else
-					(*receivers)[i].receiverNode->setOutputValue(j, 0);
-			}
+		return;
+	}
+
+	//A bundle for the future is copied and dispatched at its time, so receiving goes on meanwhile
+	if (engine->oscManager.getHonourTimeTags())
+	{
+		double delay = BundleScheduler::getDelay(b.TimeTag());
 
-			if ( (*receivers)[i].remoteAdding && mainComponent->activeConfigurator)
-				haveToAddCalibrationPoint = true;
-				
+		if (delay > 0 && engine->oscManager.getBundleScheduler().schedule(this, b.Contents(), (int)b.Size(), delay))
+			return;
+	}
 
-			if ( (*receivers)[i].remoteClearing && mainComponent->activeConfigurator)
-				haveToClearCalibration = true;
-				
+	dispatchBundle(b, 1, ReceiveTicks);
+}
 
-			haveToProcess = true;
-		}
+void PortListener::dispatchScheduledBundle(const char* Data, int Size)
+{
+	osc::ReceivedBundle b(osc::ReceivedPacket(Data, Size));
+
+	//Traced from the time the bundle was due
+	dispatchBundle(b, b.TimeTag(), Time::getHighResolutionTicks());
+}
+
+void PortListener::dispatchBundle(const osc::ReceivedBundle& b, osc::uint64 OutputTimeTag, int64 ReceiveTicks)
+{
+	TraceScope trace("dispatch");
+
+	if (engine->oscManager.hasQueuedReceivers())
+	{
+		bool queued = false;
+		bool haveToApply = queueBundle(b, queued, ReceiveTicks);
+
+		if (queued)
+			engine->oscManager.notify();
+
+		if (!haveToApply)
+			return;
 	}
 
-	if (mainComponent && haveToProcess)
-		mainComponent->process();
+	bool haveToAddCalibrationPoint = false;
+	bool haveToClearCalibration = false;
 
-	if (haveToAddCalibrationPoint || haveToClearCalibration)
+	//The whole bundle is one frame: apply all values first, then evaluate the graph once
 	{
-		const MessageManagerLock mmLock;
+		const ScopedLock myScopedLock (engine->getLock());
 
-		if (mainComponent && haveToAddCalibrationPoint)
-			mainComponent->activeConfigurator->buttonClicked(mainComponent->activeConfigurator->addButton);
+		bool haveToProcess = applyBundle(b, haveToAddCalibrationPoint, haveToClearCalibration, ReceiveTicks);
 
-		if (mainComponent && haveToClearCalibration)
-			mainComponent->activeConfigurator->buttonClicked(mainComponent->activeConfigurator->clearButton);
+		if (haveToProcess)
+		{
+			engine->oscManager.setOutputTimeTag(OutputTimeTag);
+			engine->process();
+			engine->oscManager.setOutputTimeTag(1);
+		}
 	}
 
+	engine->oscManager.triggerRemoteActions(haveToAddCalibrationPoint, haveToClearCalibration);
 }
 
-void OscManager::sendOSC(String Host, int Port, String Address, vector<float> Parameters)
+bool PortListener::queueBundle(const osc::ReceivedBundle& b, bool& queued, int64 ReceiveTicks)
 {
-	int found = -1;
-	for (int i=0; i<transmitSockets.size(); i++)
+	bool result = false;
+
+	for (osc::ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i)
 	{
-		if (transmitSockets[i].host.compare(Host) == 0 && transmitSockets[i].port==Port)
+		if (i->IsBundle())
 		{
-			found = i;
+			if (queueBundle(osc::ReceivedBundle(*i), queued, ReceiveTicks))
+				result = true;
+		}
+		else
+		{
+			if (queueMessage(osc::ReceivedMessage(*i), queued, ReceiveTicks))
+				result = true;
 		}
 	}
 
-	if (found == -1)
+	return result;
+}
+
+//Pushes the message to the queues of the matching receivers that have one. Returns true if it
+//also has to be applied to receivers without a queue.
+bool PortListener::queueMessage(const osc::ReceivedMessage& m, bool& queued, int64 ReceiveTicks)
+{
+	bool result = false;
+
+	const ScopedLock dispatchLock (dispatchTable->getLock());
+
+	matches.clear();
+	dispatchTable->match(port, m.AddressPattern(), matches);
+
+	for (unsigned int k=0; k<matches.size(); k++)
 	{
-		TransmitSocket ts;
-		ts.host = Host;
-		ts.port = Port;
-		ts.udpsocket = new UdpTransmitSocket(IpEndpointName( Host.toCString(), Port ));
+		ReceiverRegistration& receiver = (*receivers)[matches[k]];
+
+		if (receiver.queue)
+		{
+			receiver.queue->push(m, ReceiveTicks);
+			queued = true;
+		}
+		else
+			result = true;
+	}
+
+	return result;
+}
+
+bool PortListener::applyBundle(const osc::ReceivedBundle& b, bool& haveToAddCalibrationPoint, bool& haveToClearCalibration, int64 ReceiveTicks)
+{
+	bool result = false;
 
-		transmitSockets.push_back(ts);
-		found = transmitSockets.size()-1;
+	for (osc::ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i)
+	{
+		if (i->IsBundle())
+		{
+			if (applyBundle(osc::ReceivedBundle(*i), haveToAddCalibrationPoint, haveToClearCalibration, ReceiveTicks))
+				result = true;
+		}
+		else
+		{
+			if (applyMessage(osc::ReceivedMessage(*i), haveToAddCalibrationPoint, haveToClearCalibration, ReceiveTicks))
+				result = true;
+		}
 	}
 
-	UdpTransmitSocket* transmitSocket = transmitSockets[found].udpsocket;
+	return result;
+}
 
-    osc::OutboundPacketStream p(buffer, 1024);
-    
-	p << osc::BeginMessage( Address.toCString() );
+bool PortListener::applyMessage(const osc::ReceivedMessage& m, bool& haveToAddCalibrationPoint, bool& haveToClearCalibration, int64 ReceiveTicks)
+{
+	bool result = false;
 
-	for (unsigned int i=0; i < Parameters.size(); i++)
+	const ScopedLock dispatchLock (dispatchTable->getLock());
+
+	matches.clear();
+	dispatchTable->match(port, m.AddressPattern(), matches);
+
+	for (unsigned int k=0; k<matches.size(); k++)
 	{
-		p << Parameters[i];
+		ReceiverRegistration& receiver = (*receivers)[matches[k]];
+
+		if (receiver.queue)
+			continue;
+
+		//Decoded straight into the output values of the receiving node, missing arguments read as 0
+		float* values = receiver.receiverNode->getOutputValues();
+		unsigned long numberOfValues = receiver.receiverNode->getNumberOfOutputs();
+
+		unsigned long numberOfArguments = m.ReadFloatArguments(values, numberOfValues);
+		for (unsigned long j=numberOfArguments; j<numberOfValues; j++)
+			values[j] = 0;
+
+		receiver.receiverNode->markUpdated();
+
+		//Values applied together are traced from the oldest
+		if (receiver.receiverNode->getReceiveTicks() == 0)
+			receiver.receiverNode->setReceiveTicks(ReceiveTicks);
+
+		if (receiver.remoteAdding)
+			haveToAddCalibrationPoint = true;
+
+		if (receiver.remoteClearing)
+			haveToClearCalibration = true;
+
+		result = true;
 	}
 
-	p << osc::EndMessage;
-    
-    transmitSocket->Send( p.Data(), p.Size() );
+	return result;
 }
 
-void OscManager::deleteTransmitSocket(String Host, int Port)
+void OscManager::triggerRemoteActions(bool haveToAddCalibrationPoint, bool haveToClearCalibration)
 {
-	for (int i=0; i<transmitSockets.size(); i++)
+	EngineListener* listener = engine->getListener();
+
+	if (listener && haveToAddCalibrationPoint)
+		listener->remoteAddCalibrationPoint();
+
+	if (listener && haveToClearCalibration)
+		listener->remoteClearCalibration();
+}
+
+OscDestination* OscManager::acquireDestination(const String& Host, int Port)
+{
+	const ScopedLock myScopedLock (cs);
+
+	for (unsigned int i=0; i<destinations.size(); i++)
 	{
-		if (transmitSockets[i].host.compare(Host) == 0 && transmitSockets[i].port==Port)
+		//A ring has a single writer, whatever port its nodes have
+		if (destinations[i]->getHost() == Host && (destinations[i]->getPort() == Port || SharedMemoryRing::isRingAddress(Host)))
 		{
-			delete transmitSockets[i].udpsocket;
-			transmitSockets.erase(transmitSockets.begin()+i);
-			return;
+			destinations[i]->references++;
+			return destinations[i];
 		}
 	}
+
+	OscDestination* destination = new OscDestination(Host, Port);
+	destination->setMulticastOptions(multicastTtl, multicastInterface);
+	destination->references = 1;
+	destinations.push_back(destination);
+
+	return destination;
+}
+
+void OscManager::releaseDestination(OscDestination* Destination)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (--Destination->references > 0)
+		return;
+
+	destinations.erase(std::find(destinations.begin(), destinations.end(), Destination));
+	delete Destination;
+}
+
+void OscManager::flushOSC()
+{
+	const ScopedLock myScopedLock (cs);
+
+	for (unsigned int i=0; i<destinations.size(); i++)
+		destinations[i]->flush();
+
+	if (sentLatencies.empty())
+		return;
+
+	int64 now = Time::getHighResolutionTicks();
+
+	for (unsigned int i=0; i<sentLatencies.size(); i++)
+	{
+		sentLatencies[i].first->recordSince(sentLatencies[i].second, now);
+		sendLatency.recordSince(sentLatencies[i].second, now);
+	}
+
+	sentLatencies.clear();
+}
+
+int64 OscManager::getNumberOfReceivedPackets()
+{
+	const ScopedLock myScopedLock (listenersLock);
+
+	int64 result = 0;
+	for (unsigned int i=0; i<listeners.size(); i++)
+		result += listeners[i]->getNumberOfPackets();
+
+	return result;
+}
+
+void OscManager::traceSend(LatencyHistogram* Latency, int64 ReceiveTicks)
+{
+	if (ReceiveTicks == 0)
+		return;
+
+	const ScopedLock myScopedLock (cs);
+
+	sentLatencies.push_back(make_pair(Latency, ReceiveTicks));
 }
 
 
-void OscManager::setRemoteAdding(bool State, String Address, int Port)
+void OscManager::setRemoteAdding(bool State, EngineNode* ReceiverNode)
 {
 	for (unsigned int i=0; i<receivers.size(); i++)
 	{
 		if (State)
 		{
-			if (receivers[i].address==Address && receivers[i].port==Port)
+			if (receivers[i].receiverNode==ReceiverNode)
 			{
 				receivers[i].remoteAdding=true;
 				return;
@@ -298,13 +1198,13 @@ void OscManager::setRemoteAdding(bool State, String Address, int Port)
 	}
 }
 
-void OscManager::setRemoteClearing(bool State, String Address, int Port)
+void OscManager::setRemoteClearing(bool State, EngineNode* ReceiverNode)
 {
 	for (unsigned int i=0; i<receivers.size(); i++)
 	{
 		if (State)
 			{
-				if (receivers[i].address==Address && receivers[i].port==Port)
+				if (receivers[i].receiverNode==ReceiverNode)
 				{
 					receivers[i].remoteClearing=true;
 					return;
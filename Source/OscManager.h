@@ -20,50 +20,128 @@
 #include "../oscpack/osc/OscPacketListener.h"
 
 #include "..\juce\juce_amalgamated.h"
-#include "Node.h"
+#include "EngineNode.h"
+#include "OscDispatchTable.h"
+#include "OscDestination.h"
+#include "SharedMemoryRing.h"
+#include "SlipTcp.h"
+#include "ReceiverQueue.h"
+#include "BundleScheduler.h"
+#include "PacketCapture.h"
 
 #include <vector>
+#include <algorithm>
+#include <stdexcept>
 using namespace std;
 
-class MainComponent;
+class Engine;
+
+#define TCP_DISPATCH_OFFSET 65536
 
 struct ReceiverRegistration
 {
 	String address;
 	int numberOfParameters;
 	int port;
-	Node* receiverNode;
+	String group; //multicast group joined on the UDP port, empty for none
+	bool tcp; //receives SLIP framed packets over TCP on the port instead of UDP
+	String ring; //receives from this shared memory ring instead of the port if not empty
+	int dispatchPort; //the UDP port, TCP_DISPATCH_OFFSET + the TCP port, or a negative number standing for the ring
+	EngineNode* receiverNode;
+	ReceiverQueue* queue; //pending values evaluated by the OscManager thread, 0 for QUEUE_ALL
 	bool remoteAdding;
 	bool remoteClearing;
 };
 
-struct TransmitSocket
-{
-	UdpTransmitSocket* udpsocket;
-	int port;
-	String host;
-};
-
-class SocketThread: public Thread, public osc::OscPacketListener
+//Applies the messages received on one port to the registered receiver nodes. The packets
+//come from the socket opened with open(), or are passed to ProcessPacket by a RingReceiver
+//or TcpReceiver.
+class PortListener: public osc::OscPacketListener
 {
 public:
-	SocketThread(vector<ReceiverRegistration> *Receivers, int Port, MainComponent* theMainComponent);
-	~SocketThread();
+	PortListener(vector<ReceiverRegistration> *Receivers, OscDispatchTable* DispatchTable, int Port, Engine* theEngine);
+	~PortListener();
+
+	//Throws std::runtime_error if the port can't be bound. Shared sockets let other sockets
+	//bind the same port, to spread its senders across threads.
+	void open(bool Shared);
+
+	//Joins these multicast groups on the interface and leaves the others. The socket only
+	//receives the groups joined on it, so a group is joined by one socket of the port.
+	void setGroups(const StringArray& Groups, const String& Interface);
 
 	int getPort();
+	UdpSocket* getSocket() {return s;};
+	int64 getNumberOfPackets() {return numberOfPackets;};
 
-	void run();
-	void Break();
+	//Called by the BundleScheduler when a bundle held for its time tag is due
+	void dispatchScheduledBundle(const char* Data, int Size);
+
+	//Records the datagrams of the socket before they are dispatched, if capturing
+	virtual void ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint);
 
 private:
 	vector<ReceiverRegistration> *receivers;
+	OscDispatchTable* dispatchTable;
+	vector<int> matches; //receiver indices of the message being dispatched (reused, so dispatching doesn't allocate)
 	int port;
-	UdpListeningReceiveSocket* s;
+	UdpSocket* s;
+	StringArray groups; //joined on groupInterface
+	String groupInterface;
 
-	MainComponent* mainComponent;
+	Engine* engine;
+	int64 numberOfPackets; //datagrams received, only written by the thread serving the socket
+
+	bool queueMessage(const osc::ReceivedMessage& m, bool& queued, int64 ReceiveTicks);
+	bool queueBundle(const osc::ReceivedBundle& b, bool& queued, int64 ReceiveTicks);
+	bool applyMessage(const osc::ReceivedMessage& m, bool& haveToAddCalibrationPoint, bool& haveToClearCalibration, int64 ReceiveTicks);
+	bool applyBundle(const osc::ReceivedBundle& b, bool& haveToAddCalibrationPoint, bool& haveToClearCalibration, int64 ReceiveTicks);
+	void receiveMessage(const osc::ReceivedMessage& m, int64 ReceiveTicks);
+	void receiveBundle(const osc::ReceivedBundle& b, int64 ReceiveTicks);
+	void dispatchBundle(const osc::ReceivedBundle& b, osc::uint64 OutputTimeTag, int64 ReceiveTicks);
+	void replyStatistics(const IpEndpointName& remoteEndpoint);
 
 protected:
 	virtual void ProcessMessage(const osc::ReceivedMessage& m, const IpEndpointName& remoteEndpoint);
+	virtual void ProcessBundle(const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint);
+};
+
+//Polls a shared memory ring for packets, which are dispatched by its own listener
+class RingReceiver: public Thread
+{
+public:
+	RingReceiver(const String& Name, PortListener* Listener);
+	~RingReceiver();
+
+	bool open();
+	const String& getName() {return name;};
+
+	void run();
+
+private:
+	String name;
+	SharedMemoryRing ring;
+	PortListener* listener;
+};
+
+//Waits for the sockets of any number of ports at once
+class ReceiveThread: public Thread
+{
+public:
+	ReceiveThread();
+	~ReceiveThread();
+
+	void attach(PortListener* listener);
+	bool detach(PortListener* listener); //false if the listener isn't served by this thread
+	int getNumberOfPorts() {return (int)listeners.size();};
+	bool servesPort(int Port);
+
+	void run();
+	void stop();
+
+private:
+	SocketReceiveMultiplexer multiplexer;
+	vector<PortListener*> listeners;
 };
 
 
@@ -75,15 +153,77 @@ public:
     OscManager ();
     ~OscManager();
 
-	void registerReceiver(String Address, int NumberOfParameters, int Port, Node* ReceiverNode);
-	void unregisterReceiver(Node* ReceiverNode);
+	//Receives on the UDP port (joining the multicast Group unless it's empty), on the TCP port
+	//if Tcp is set, or on the shared memory ring of that name if Ring isn't empty
+	void registerReceiver(String Address, int NumberOfParameters, int Port, String Group, bool Tcp, String Ring, EngineNode* ReceiverNode);
+	void unregisterReceiver(EngineNode* ReceiverNode);
+
+	void setEngine(Engine *theEngine);
+	//Output destinations are shared by the nodes sending to the same host and port. Their
+	//packets are queued during a processing pass and sent by flushOSC at its end.
+	OscDestination* acquireDestination(const String& Host, int Port);
+	void releaseDestination(OscDestination* Destination);
+	void flushOSC();
+
+	//Records the time from receiving to leaving through flushOSC of a queued message in
+	//Latency and in the send latency of all outputs. Untraced if ReceiveTicks is 0.
+	void traceSend(LatencyHistogram* Latency, int64 ReceiveTicks);
+	LatencyHistogram& getSendLatency() {return sendLatency;};
+
+	//The datagrams received on the UDP ports so far
+	int64 getNumberOfReceivedPackets();
 
-	void setMainComponent(MainComponent *theMainComponent);
-	void sendOSC(String Host, int Port, String Address, vector<float> Parameters);
-	void deleteTransmitSocket(String Host, int Port);
+	//Switched on for one receiver node, or off for all
+	void setRemoteAdding(bool State, EngineNode* ReceiverNode);
+	void setRemoteClearing(bool State, EngineNode* ReceiverNode);
+	void triggerRemoteActions(bool haveToAddCalibrationPoint, bool haveToClearCalibration); //without the engine lock
 
-	void setRemoteAdding(bool State, String Address, int Port);
-	void setRemoteClearing(bool State, String Address, int Port);
+	//QUEUE_ALL (the default) evaluates every message of the receiver as it arrives. The other
+	//policies queue the values for evaluation by this thread, so the receiving threads keep
+	//draining the sockets while the graph evaluation falls behind (see ReceiverQueue).
+	void setQueuePolicy(EngineNode* ReceiverNode, int Policy, int Capacity);
+	int getNumberOfDroppedMessages(EngineNode* ReceiverNode);
+	bool hasQueuedReceivers() {return numberOfQueuedReceivers > 0;};
+
+	//Bundle frames: all messages of a bundle are applied before a single processing pass
+	void setBundleFrames(bool State) {bundleFrames=State;};
+	bool getBundleFrames() {return bundleFrames;};
+	//Bundles with a time tag in the future are held and dispatched at that time, and the
+	//output bundles of their pass carry the same time tag
+	void setHonourTimeTags(bool State) {honourTimeTags=State;};
+	bool getHonourTimeTags() {return honourTimeTags;};
+	BundleScheduler& getBundleScheduler() {return bundleScheduler;};
+
+	//Records the received UDP datagrams to a file, for replaying them as a load test
+	PacketCapture& getCapture() {return capture;};
+
+	//STATS_ADDRESS queries are only answered when enabled (they are off by default), from the
+	//loopback interface or one of the comma separated hosts, and at most every STATS_INTERVAL ms
+	void setStatisticsQueries(bool Enabled, const String& AllowedHosts);
+	bool getStatisticsQueries() {return statisticsQueries;};
+	String getStatisticsAllowedHosts() {return statisticsAllowedHosts;};
+	bool acceptStatisticsQuery(const IpEndpointName& From);
+
+	//The time tag of the output bundles queued in the current pass, 1 (immediately) unless
+	//the pass dispatches a scheduled bundle. Used with the engine lock held.
+	osc::uint64 getOutputTimeTag() {return outputTimeTag;};
+	void setOutputTimeTag(osc::uint64 TimeTag) {outputTimeTag=TimeTag;};
+
+	//The ports are served by this many threads (1 by default)
+	void setNumberOfReceiveThreads(int Number);
+	int getNumberOfReceiveThreads() {return numberOfReceiveThreads;};
+
+	//Each port is received by this many sockets, each on its own thread (1 by default). The
+	//kernel keeps the packets of one sender on one socket, so they are applied in order.
+	//Only available where OSC_SOCKET_REUSE_BALANCES is defined (Linux).
+	void setNumberOfSocketsPerPort(int Number);
+	int getNumberOfSocketsPerPort() {return numberOfSocketsPerPort;};
+
+	//Multicast destinations are sent with this TTL (1 by default, the local network) and on
+	//this interface; groups are joined on it. An empty Interface uses the default one.
+	void setMulticastOptions(int Ttl, const String& Interface);
+	int getMulticastTtl() {return multicastTtl;};
+	String getMulticastInterface() {return multicastInterface;};
 
 	void run();
 	void stop();
@@ -92,12 +232,43 @@ public:
     juce_UseDebuggingNewOperator
 
 private:
+	friend class ReceivePathTests; //drives a PortListener on the receivers
+
 	vector<ReceiverRegistration> receivers;
-	vector<SocketThread*> sockets;
-	vector<TransmitSocket> transmitSockets;
-	char buffer[1024];
+	OscDispatchTable dispatchTable;
+	vector<ReceiveThread*> receiveThreads;
+	vector<PortListener*> listeners;
+	CriticalSection listenersLock; //guards listeners against getNumberOfReceivedPackets
+	vector<RingReceiver*> ringReceivers;
+	vector<TcpReceiver*> tcpReceivers;
+	StringArray ringNames; //rings are dispatched as port -(index+1), kept stable while running
+	vector<OscDestination*> destinations;
+	vector<pair<LatencyHistogram*, int64> > sentLatencies; //queued in the current pass
+	LatencyHistogram sendLatency;
 
-	MainComponent *mainComponent;
+	bool bundleFrames;
+	bool honourTimeTags;
+	bool statisticsQueries;
+	String statisticsAllowedHosts;
+	vector<unsigned long> statisticsAllowed; //addresses of the allowed hosts
+	uint32 lastStatisticsReply; //Time::getMillisecondCounter
+	BundleScheduler bundleScheduler;
+	PacketCapture capture;
+	osc::uint64 outputTimeTag;
+	int numberOfReceiveThreads;
+	int numberOfSocketsPerPort;
+	int openSocketsPerPort; //the number the current sockets were opened with
+	int multicastTtl;
+	String multicastInterface;
+	volatile bool socketsChanged; //the ports of the receivers changed since the sockets were last updated
+	volatile int numberOfQueuedReceivers;
+
+	Engine *engine;
 
 	CriticalSection cs;
+
+	void rebuildDispatchTable();
+	void updateSockets();
+	void closeSockets();
+	void processQueues();
 };
\ No newline at end of file
@@ -13,6 +13,7 @@
 
 
 #include "OscOutputConfigurator.h"
+#include "OscOutputEngineNode.h"
 
 OscOutputConfigurator::OscOutputConfigurator ()
     : hostLabel (0),
@@ -23,6 +24,13 @@ OscOutputConfigurator::OscOutputConfigurator ()
       portEditor (0),
       parameterslabel (0),
       parametersEditor (0),
+	  bundleToggle (0),
+	  sendModeLabel (0),
+	  sendModeComboBox (0),
+	  rateLabel (0),
+	  rateEditor (0),
+	  epsilonLabel (0),
+	  epsilonEditor (0),
       okButton (0),
       cancelButton (0)
 {
@@ -94,6 +102,43 @@ OscOutputConfigurator::OscOutputConfigurator ()
     parametersEditor->setPopupMenuEnabled (true);
     parametersEditor->setText ("1");
 
+	addAndMakeVisible (bundleToggle = new ToggleButton (T("Send in bundles")));
+	bundleToggle->setToggleState (true, false);
+
+	addAndMakeVisible (sendModeLabel = new Label (T("send"),
+                                                  T("Send:")));
+	sendModeLabel->setFont (Font (15.0000f, Font::plain));
+	sendModeLabel->setJustificationType (Justification::centredLeft);
+	sendModeLabel->setEditable (false, false, false);
+
+	addAndMakeVisible (sendModeComboBox = new ComboBox (T("send")));
+	sendModeComboBox->addItem (T("Every evaluation"), SEND_ALWAYS + 1);
+	sendModeComboBox->addItem (T("On change"), SEND_ON_CHANGE + 1);
+	sendModeComboBox->addItem (T("At a fixed rate"), SEND_CLOCKED + 1);
+	sendModeComboBox->setSelectedId (SEND_ALWAYS + 1, true);
+
+	addAndMakeVisible (rateLabel = new Label (T("rate"),
+                                              T("Rate (Hz):")));
+	rateLabel->setFont (Font (15.0000f, Font::plain));
+	rateLabel->setJustificationType (Justification::centredLeft);
+	rateLabel->setEditable (false, false, false);
+
+	addAndMakeVisible (rateEditor = new TextEditor (String::empty));
+	rateEditor->setMultiLine (false);
+	rateEditor->setReturnKeyStartsNewLine (false);
+	rateEditor->setText ("0");
+
+	addAndMakeVisible (epsilonLabel = new Label (T("epsilon"),
+                                                 T("Epsilon:")));
+	epsilonLabel->setFont (Font (15.0000f, Font::plain));
+	epsilonLabel->setJustificationType (Justification::centredLeft);
+	epsilonLabel->setEditable (false, false, false);
+
+	addAndMakeVisible (epsilonEditor = new TextEditor (String::empty));
+	epsilonEditor->setMultiLine (false);
+	epsilonEditor->setReturnKeyStartsNewLine (false);
+	epsilonEditor->setText ("0");
+
     addAndMakeVisible (okButton = new TextButton (String::empty));
     okButton->setButtonText (T("Accept"));
     okButton->addListener (this);
@@ -108,7 +153,7 @@ OscOutputConfigurator::OscOutputConfigurator ()
     //[UserPreSize]
     //[/UserPreSize]
 
-    setSize (400, 137);
+    setSize (400, 232);
 
     //[Constructor] You can add your own custom stuff here..
     //[/Constructor]
@@ -129,6 +174,13 @@ OscOutputConfigurator::~OscOutputConfigurator()
     deleteAndZero (portEditor);
     deleteAndZero (parameterslabel);
     deleteAndZero (parametersEditor);
+	deleteAndZero (bundleToggle);
+	deleteAndZero (sendModeLabel);
+	deleteAndZero (sendModeComboBox);
+	deleteAndZero (rateLabel);
+	deleteAndZero (rateEditor);
+	deleteAndZero (epsilonLabel);
+	deleteAndZero (epsilonEditor);
     deleteAndZero (okButton);
     deleteAndZero (cancelButton);
 
@@ -158,6 +210,13 @@ void OscOutputConfigurator::resized()
     portEditor->setBounds (56, 72, 168, 24);
     parameterslabel->setBounds (8, 104, 160, 24);
     parametersEditor->setBounds (168, 104, 56, 24);
+	bundleToggle->setBounds (8, 136, 216, 24);
+	sendModeLabel->setBounds (12, 168, 44, 24);
+	sendModeComboBox->setBounds (56, 168, 168, 24);
+	rateLabel->setBounds (240, 168, 72, 24);
+	rateEditor->setBounds (312, 168, 80, 24);
+	epsilonLabel->setBounds (0, 200, 56, 24);
+	epsilonEditor->setBounds (56, 200, 336, 24);
     okButton->setBounds (240, 72, 150, 24);
     cancelButton->setBounds (240, 104, 150, 24);
     //[UserResized] Add your own custom resize handling here..
@@ -198,6 +257,26 @@ int OscOutputConfigurator::getNumberOfParameters()
 	return parametersEditor->getText().getIntValue();
 }
 
+bool OscOutputConfigurator::getBundled()
+{
+	return bundleToggle->getToggleState();
+}
+
+int OscOutputConfigurator::getSendMode()
+{
+	return sendModeComboBox->getSelectedId() - 1;
+}
+
+double OscOutputConfigurator::getRate()
+{
+	return rateEditor->getText().getDoubleValue();
+}
+
+String OscOutputConfigurator::getEpsilons()
+{
+	return epsilonEditor->getText();
+}
+
 void OscOutputConfigurator::setHost(String Host)
 {
 	hostEditor->setText(Host);
@@ -216,4 +295,16 @@ void OscOutputConfigurator::setPort(int Port)
 void OscOutputConfigurator::setNumberOfParameters(int NumberOfParameters)
 {
 	parametersEditor->setText(String(NumberOfParameters));
+}
+
+void OscOutputConfigurator::setBundled(bool Bundled)
+{
+	bundleToggle->setToggleState(Bundled, false);
+}
+
+void OscOutputConfigurator::setSchedule(int SendMode, double Rate, const String& Epsilons)
+{
+	sendModeComboBox->setSelectedId(SendMode + 1, true);
+	rateEditor->setText(String(Rate));
+	epsilonEditor->setText(Epsilons);
 }
\ No newline at end of file
@@ -36,12 +36,18 @@ public:
 	String getAddress();
 	int getPort();
 	int getNumberOfParameters();
+	bool getBundled();
+	int getSendMode();
+	double getRate();
+	String getEpsilons();
 	bool okClicked;
 
 	void setHost(String Host);
 	void setAddress(String Address);
 	void setPort(int Port);
 	void setNumberOfParameters(int NumberOfParameters);
+	void setBundled(bool Bundled);
+	void setSchedule(int SendMode, double Rate, const String& Epsilons);
 
     //==============================================================================
     juce_UseDebuggingNewOperator
@@ -59,6 +65,13 @@ private:
     TextEditor* portEditor;
     Label* parameterslabel;
     TextEditor* parametersEditor;
+	ToggleButton* bundleToggle;
+	Label* sendModeLabel;
+	ComboBox* sendModeComboBox;
+	Label* rateLabel;
+	TextEditor* rateEditor;
+	Label* epsilonLabel;
+	TextEditor* epsilonEditor;
     TextButton* okButton;
     TextButton* cancelButton;
 
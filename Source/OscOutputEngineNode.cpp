@@ -0,0 +1,246 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "OscOutputEngineNode.h"
+#include "Pool.h"
+
+#include <math.h>
+
+OscOutputEngineNode::OscOutputEngineNode()
+{
+	oscManager=(OscManager*)Pool::Instance()->getObject("OscManager");
+	type=OUTPUTNODE;
+
+	host = "127.0.0.1";
+	port = 3334;
+	address = "/address";
+	bundled = true;
+
+	destination = 0;
+
+	clock=(OutputClock*)Pool::Instance()->getObject("OutputClock");
+	scheduled = false;
+	setSchedule(SEND_ALWAYS, 0, "0");
+}
+
+OscOutputEngineNode::~OscOutputEngineNode()
+{
+	if (scheduled)
+		clock->remove(this);
+
+	if (destination)
+		oscManager->releaseDestination(destination);
+}
+
+void OscOutputEngineNode::process()
+{
+	evaluated = true;
+
+	if (sendMode == SEND_ON_CHANGE)
+	{
+		//A value that returned to the one sent cancels a held back change
+		pending = hasChanged();
+		if (!pending)
+			return;
+	}
+
+	//The clock sends the latest values
+	if (sendMode == SEND_CLOCKED)
+		return;
+
+	double now = Time::getMillisecondCounterHiRes();
+
+	if (rate > 0 && now < lastSent + 1000.0 / rate)
+	{
+		pending = true;
+		clock->wake();
+		return;
+	}
+
+	send(now);
+}
+
+double OscOutputEngineNode::sendScheduled(double Now)
+{
+	if (sendMode == SEND_CLOCKED)
+	{
+		if (Now < nextTick)
+			return nextTick;
+
+		if (evaluated)
+			send(Now);
+
+		//A clock that fell behind skips the missed ticks instead of sending them in a burst
+		nextTick += 1000.0 / rate;
+		if (nextTick <= Now)
+			nextTick = Now + 1000.0 / rate;
+
+		return nextTick;
+	}
+
+	if (!pending)
+		return 0;
+
+	double due = lastSent + 1000.0 / rate;
+	if (Now < due)
+		return due;
+
+	send(Now);
+	return 0;
+}
+
+void OscOutputEngineNode::send(double Now)
+{
+	if (message.getNumberOfArguments() != getNumberOfInputs())
+		message.setAddress(address, getNumberOfInputs());
+
+	if (!inputValues.empty())
+		message.setArguments(&inputValues[0]);
+
+	if (destination == 0)
+		updateDestination();
+
+	destination->queue(message.getData(), message.getSize(), bundled, oscManager->getOutputTimeTag());
+
+	//Values sent again by the clock aren't traced again
+	oscManager->traceSend(&sendLatency, receiveTicks);
+	receiveTicks = 0;
+
+	sentValues = inputValues;
+	lastSent = Now;
+	pending = false;
+}
+
+void OscOutputEngineNode::resetStatistics()
+{
+	EngineNode::resetStatistics();
+	sendLatency.reset();
+}
+
+bool OscOutputEngineNode::hasChanged()
+{
+	if (sentValues.size() != inputValues.size())
+		return true;
+
+	for (unsigned int j=0; j<inputValues.size(); j++)
+	{
+		float e = epsilon.empty() ? 0 : epsilon[jmin((int)j, (int)epsilon.size()-1)];
+
+		if (fabs(inputValues[j] - sentValues[j]) > e)
+			return true;
+	}
+
+	return false;
+}
+
+void OscOutputEngineNode::setSchedule(int SendMode, double Rate, const String& Epsilons)
+{
+	sendMode = SendMode;
+	rate = jmax(0.0, Rate);
+	epsilons = Epsilons;
+
+	//A clock needs a rate
+	if (sendMode == SEND_CLOCKED && rate <= 0)
+		sendMode = SEND_ALWAYS;
+
+	StringArray tokens;
+	tokens.addTokens(epsilons, ", ", String::empty);
+	tokens.removeEmptyStrings();
+
+	epsilon.clear();
+	for (int i=0; i<tokens.size(); i++)
+		epsilon.push_back(fabs(tokens[i].getFloatValue()));
+
+	updateSchedule();
+}
+
+void OscOutputEngineNode::updateSchedule()
+{
+	sentValues.clear();
+	lastSent = 0;
+	nextTick = Time::getMillisecondCounterHiRes();
+	evaluated = false;
+	pending = false;
+
+	bool needsClock = (sendMode == SEND_CLOCKED || rate > 0);
+
+	if (needsClock && !scheduled)
+		clock->add(this);
+	else if (!needsClock && scheduled)
+		clock->remove(this);
+
+	scheduled = needsClock;
+}
+
+void OscOutputEngineNode::setAddress(String Address)
+{
+	address = Address;
+	message.setAddress(address, getNumberOfInputs());
+}
+
+void OscOutputEngineNode::setDestination(const String& Host, int Port)
+{
+	if (destination && Host == host && Port == port)
+		return;
+
+	host = Host;
+	port = Port;
+	updateDestination();
+}
+
+void OscOutputEngineNode::updateDestination()
+{
+	OscDestination* previous = destination;
+
+	destination = oscManager->acquireDestination(host, port);
+
+	if (previous)
+		oscManager->releaseDestination(previous);
+}
+
+void OscOutputEngineNode::readXml(const XmlElement& NodeElement)
+{
+	EngineNode::readXml(NodeElement);
+
+	address = NodeElement.getStringAttribute("address");
+	host = NodeElement.getStringAttribute("host");
+	port = NodeElement.getIntAttribute("port");
+	bundled = NodeElement.getBoolAttribute("bundle", false); //configurations from before bundling keep sending plain messages
+	setSchedule(NodeElement.getIntAttribute("sendMode", SEND_ALWAYS), NodeElement.getDoubleAttribute("rate", 0), NodeElement.getStringAttribute("epsilon", "0"));
+
+	int numberOfInputs=0;
+	forEachXmlChildElementWithTagName (NodeElement, e, "Input")
+		numberOfInputs++;
+
+	setNumberOfInputs(numberOfInputs);
+
+	message.setAddress(address, numberOfInputs);
+	updateDestination();
+}
+
+void OscOutputEngineNode::writeXml(XmlElement& NodeElement)
+{
+	EngineNode::writeXml(NodeElement);
+
+	NodeElement.setAttribute("address", address);
+	NodeElement.setAttribute("port", port);
+	NodeElement.setAttribute("host", host);
+	NodeElement.setAttribute("bundle", bundled);
+	NodeElement.setAttribute("sendMode", sendMode);
+	NodeElement.setAttribute("rate", rate);
+	NodeElement.setAttribute("epsilon", epsilons);
+
+	for (int i=0; i<getNumberOfInputs(); i++)
+		NodeElement.createNewChildElement("Input");
+}
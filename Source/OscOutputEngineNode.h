@@ -0,0 +1,89 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "EngineNode.h"
+#include "OscManager.h"
+#include "OutputClock.h"
+
+#define SEND_ALWAYS 0 //with every evaluation of the node
+#define SEND_ON_CHANGE 1 //when an input moved further than its epsilon from the value last sent
+#define SEND_CLOCKED 2 //the latest values at a fixed rate
+
+class OscOutputEngineNode : public EngineNode, public ScheduledSender
+{
+public:
+	OscOutputEngineNode();
+	~OscOutputEngineNode();
+
+	void process();
+
+	String getAddress() {return address;};
+	int getPort() {return port;};
+	String getHost() {return host;};
+	void setAddress(String Address);
+	//Acquires the destination for both at once, keeping the current one if neither changes
+	void setDestination(const String& Host, int Port);
+	bool isBundled() {return bundled;};
+	void setBundled(bool Bundled) {bundled=Bundled;}; //false for receivers that can't parse bundles
+
+	//The rate is the clock rate in Hz for SEND_CLOCKED, otherwise the maximum rate (0 for none),
+	//at which a held back change is sent once the interval has passed. The epsilons are a list
+	//with one per input, the last one applies to the remaining inputs.
+	int getSendMode() {return sendMode;};
+	double getRate() {return rate;};
+	String getEpsilons() {return epsilons;};
+	void setSchedule(int SendMode, double Rate, const String& Epsilons);
+
+	double sendScheduled(double Now);
+
+	//From receiving to leaving the socket, per path to this output
+	LatencyHistogram& getSendLatency() {return sendLatency;};
+	void resetStatistics();
+
+	void readXml(const XmlElement& NodeElement);
+	void writeXml(XmlElement& NodeElement);
+
+	juce_UseDebuggingNewOperator
+
+private:
+	OscManager* oscManager;
+	OscDestination* destination; //acquired when the host and port are set, or by the first send of a node that keeps the defaults
+	OscMessageTemplate message; //encoded whenever the address or the number of inputs changes
+	String address;
+	String host;
+	int port;
+	bool bundled;
+
+	int sendMode;
+	double rate;
+	String epsilons;
+	vector<float> epsilon; //parsed from epsilons
+	OutputClock* clock;
+	bool scheduled; //added to the clock
+
+	vector<float> sentValues;
+	double lastSent;
+	double nextTick;
+	bool evaluated; //processed since the schedule was set, so there are values to send
+	bool pending; //a change is held back by the rate limit
+	LatencyHistogram sendLatency;
+
+	void updateDestination();
+	void updateSchedule();
+	bool hasChanged();
+	void send(double Now);
+};
@@ -15,29 +15,20 @@
 #include "OscOutputNode.h"
 #include "MainComponent.h"
 
-OscOutputNode::OscOutputNode ()
+OscOutputNode::OscOutputNode (OscOutputEngineNode* theEngineNode)
 {
 	title->setText("Osc output", false);
 	title->addMouseListener(title->getParentComponent(), false);
 
-	oscManager=(OscManager*)Pool::Instance()->getObject("OscManager");
 	type=OUTPUTNODE;
+	engineNode=theEngineNode;
 
-	host = "127.0.0.1";
-	port = 3334;
-	address = "/address";
-
-	//transmitSocket = 0;
+	createConnectors(engineNode->getNumberOfInputs(), 0);
 }
 
 OscOutputNode::~OscOutputNode()
 {
-	oscManager->deleteTransmitSocket(host, port);
-	
-	/*if (transmitSocket)
-	{
-	 	delete transmitSocket;
-	}*/
+
 }
 
 void OscOutputNode::mouseDoubleClick(const MouseEvent &e)
@@ -49,39 +40,34 @@ void OscOutputNode::mouseDoubleClick(const MouseEvent &e)
 		configurator->setAddress(getAddress());
 		configurator->setPort(getPort());
 		configurator->setNumberOfParameters(getNumberOfInputs());
+		configurator->setBundled(getOutputEngineNode()->isBundled());
+		configurator->setSchedule(getOutputEngineNode()->getSendMode(), getOutputEngineNode()->getRate(), getOutputEngineNode()->getEpsilons());
 
 
 		DialogWindow::showModalDialog(title->getText()+" configuration", configurator, this, Colours::lightgrey, false);
 		
 		if (configurator->okClicked)
 		{
+			MainComponent* mainComponent = (MainComponent*)e.eventComponent->getParentComponent();
+
+			if (configurator->getNumberOfParameters() != getNumberOfInputs())
+				mainComponent->deleteConnectionsOfNode((Node*)e.eventComponent);
+
+			const ScopedLock myScopedLock (mainComponent->engine.getLock());
+
 			if (configurator->getNumberOfParameters() != getNumberOfInputs())
 			{
-				((MainComponent*)e.eventComponent->getParentComponent())->deleteConnectionsOfNode((Node*)e.eventComponent);
-
-				for (unsigned int i=0; i<inputConnectors.size(); i++)
-					deleteAndZero(inputConnectors[i]);
-				inputConnectors.clear();
-
-				for (int i=0; i<configurator->getNumberOfParameters(); i++)
-				{
-					InputConnector* inputConnector = new InputConnector();
-					inputConnector->setID(i);
-					addAndMakeVisible(inputConnector);
-					inputConnectors.push_back(inputConnector);
-				}
-
-				if (inputConnectors.size()==0)
-				{
-					setSize(100, 40);
-				}
-				else
-					setSize(100, 20+inputConnectors.size()*20);
+				engineNode->setNumberOfInputs(configurator->getNumberOfParameters());
+				createConnectors(configurator->getNumberOfParameters(), 0);
 			}
 
-			setHost(configurator->getHost());
-			setPort(configurator->getPort());
-			address=configurator->getAddress();
+			getOutputEngineNode()->setDestination(configurator->getHost(), configurator->getPort());
+			getOutputEngineNode()->setAddress(configurator->getAddress());
+			getOutputEngineNode()->setBundled(configurator->getBundled());
+			getOutputEngineNode()->setSchedule(configurator->getSendMode(), configurator->getRate(), configurator->getEpsilons());
+
+			//Resend to the new destination even if the values stay the same
+			engineNode->markUpdated();
 
 			resized();
 		}
@@ -89,53 +75,3 @@ void OscOutputNode::mouseDoubleClick(const MouseEvent &e)
 		delete configurator;
 	}
 }
-
-void OscOutputNode::process()
-{
-	vector<float> parameters;
-
-	for (unsigned int i=0; i<inputConnectors.size(); i++)
-	{
-		parameters.push_back(inputConnectors[i]->getValue());
-	}
-
-	
-/*	if (transmitSocket)
-	{
-		osc::OutboundPacketStream p(buffer, 1024);
-    
-		p << osc::BeginMessage( address.toCString() );
-
-		for (unsigned int i=0; i < parameters.size(); i++)
-		{
-			p << parameters[i];
-		}
-
-		p << osc::EndMessage;
-    
-		transmitSocket->Send( p.Data(), p.Size() );
-	} */
-	
-	oscManager->sendOSC(host, port, address, parameters);
-}
-
-void OscOutputNode::setPort(int Port)
-{
-	port = Port;
-
-/*	if (transmitSocket)
-		delete transmitSocket;
-
-	transmitSocket = new UdpTransmitSocket(IpEndpointName( host.toCString(), port)); */ 
-}
-
-
-void OscOutputNode::setHost(String Host)
-{
-	host = Host;
-
-/*	if (transmitSocket)
-		delete transmitSocket;
-
-	transmitSocket = new UdpTransmitSocket(IpEndpointName( host.toCString(), port)); */
-}
@@ -19,36 +19,23 @@
 #include "OscOutputConfigurator.h"
 #include "OscManager.h"
 #include "Pool.h"
+#include "OscOutputEngineNode.h"
 
 class OscOutputNode  : public Node
 {
 public:
     //==============================================================================
-    OscOutputNode ();
+    OscOutputNode (OscOutputEngineNode* theEngineNode);
     ~OscOutputNode();
 
-	//void setOscManager(OscManager* theOscManager) {oscManager=theOscManager;};
-
 	void mouseDoubleClick(const MouseEvent &e);
 
-	String getAddress() {return address;};
-	String getHost() {return host;};
-	int getPort() {return port;};
-	void setAddress(String Address) {address=Address;};
-	void setHost(String Host);
-	void setPort(int Port);
-
-	virtual void process();
+	String getAddress() {return getOutputEngineNode()->getAddress();};
+	String getHost() {return getOutputEngineNode()->getHost();};
+	int getPort() {return getOutputEngineNode()->getPort();};
+	OscOutputEngineNode* getOutputEngineNode() {return (OscOutputEngineNode*)engineNode;};
 
     //==============================================================================
     juce_UseDebuggingNewOperator
 
-private:
-	OscManager* oscManager;
-	String host;
-	int port;
-	String address;
-
-//	UdpTransmitSocket* transmitSocket;
-//	char buffer[512];
 };
@@ -0,0 +1,89 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "OutputClock.h"
+#include "Engine.h"
+#include "Pool.h"
+
+#include <algorithm>
+#include <math.h>
+
+OutputClock::OutputClock() : Thread("OutputClock")
+{
+	engine=0;
+	Pool::Instance()->reg("OutputClock", this);
+}
+
+OutputClock::~OutputClock()
+{
+
+}
+
+void OutputClock::add(ScheduledSender* Sender)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (find(senders.begin(), senders.end(), Sender) == senders.end())
+		senders.push_back(Sender);
+
+	notify();
+}
+
+void OutputClock::remove(ScheduledSender* Sender)
+{
+	const ScopedLock myScopedLock (cs);
+
+	vector<ScheduledSender*>::iterator it = find(senders.begin(), senders.end(), Sender);
+	if (it != senders.end())
+		senders.erase(it);
+}
+
+void OutputClock::run()
+{
+	TraceThread traceThread;
+
+	while (!threadShouldExit())
+	{
+		double next = 0;
+
+		{
+			const ScopedLock engineLock (engine->getLock());
+			const ScopedLock myScopedLock (cs);
+
+			if (!senders.empty())
+			{
+				double now = Time::getMillisecondCounterHiRes();
+
+				for (unsigned int i=0; i<senders.size(); i++)
+				{
+					double due = senders[i]->sendScheduled(now);
+
+					if (due > 0 && (next == 0 || due < next))
+						next = due;
+				}
+
+				engine->oscManager.flushOSC();
+			}
+		}
+
+		if (next == 0)
+			wait(-1);
+		else
+		{
+			int delay = (int)ceil(next - Time::getMillisecondCounterHiRes());
+			if (delay > 0)
+				wait(delay);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+#include <vector>
+using namespace std;
+
+class Engine;
+
+//An output that sends on its own schedule rather than with every evaluation
+class ScheduledSender
+{
+public:
+	virtual ~ScheduledSender() {};
+
+	//Called with the engine lock held. Sends whatever is due at Now (in milliseconds, see
+	//Time::getMillisecondCounterHiRes) and returns when it has to be called next, or 0 if
+	//not before the next wake().
+	virtual double sendScheduled(double Now) = 0;
+};
+
+//The timer thread of the scheduled outputs. It sleeps until the earliest time one of them
+//is due and flushes the OSC output after calling them. The waits have the resolution of the
+//system timer; the rates are kept exact on average, as the due times are absolute.
+class OutputClock : public Thread
+{
+public:
+	OutputClock();
+	~OutputClock();
+
+	void setEngine(Engine* theEngine) {engine=theEngine;};
+
+	void add(ScheduledSender* Sender);
+	void remove(ScheduledSender* Sender);
+	void wake() {notify();}; //a sender has something new to schedule
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	vector<ScheduledSender*> senders;
+	Engine* engine;
+
+	CriticalSection cs;
+};
@@ -37,7 +37,6 @@ OutputConnector::OutputConnector ()
 	id=-1;
 	isConnected=false;
 	dragInside=false;
-	value=0;
 }
 
 OutputConnector::~OutputConnector()
@@ -178,10 +177,9 @@ void OutputConnector::itemDropped (const String &dragSourceDetails, Component* s
 		{
 			mainComponent->activeConfigurator->setRemoteAdding(true);
 
-			String address = ((OscInputNode*)getParentComponent())->getAddress();
-			int port = ((OscInputNode*)getParentComponent())->getPort();
+			EngineNode* receiverNode = ((OscInputNode*)getParentComponent())->getEngineNode();
 			
-			mainComponent->oscManager.setRemoteAdding(true, address, port); 
+			mainComponent->engine.oscManager.setRemoteAdding(true, receiverNode); 
 		}
 	}
 	else if (dragSourceDetails.contains("clearremote"))
@@ -192,10 +190,9 @@ void OutputConnector::itemDropped (const String &dragSourceDetails, Component* s
 		{
 			mainComponent->activeConfigurator->setRemoteClearing(true);
 
-			String address = ((OscInputNode*)getParentComponent())->getAddress();
-			int port = ((OscInputNode*)getParentComponent())->getPort();
+			EngineNode* receiverNode = ((OscInputNode*)getParentComponent())->getEngineNode();
 			
-			mainComponent->oscManager.setRemoteClearing(true, address, port); 
+			mainComponent->engine.oscManager.setRemoteClearing(true, receiverNode); 
 		}
 	}
 
@@ -0,0 +1,286 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "PacketCapture.h"
+#include "LatencyHistogram.h"
+#include "../oscpack/ip/UdpSocket.h"
+
+#include <map>
+#include <stdexcept>
+using namespace std;
+
+#define MAX_REPLAY_SOCKETS 1024 //senders beyond these share the last socket
+#define CAPTURE_FILE_RECORD_HEADER 20 //bytes in the file before the datagram
+
+static const char captureMagic[8] = {'O', 'S', 'C', 'C', 'A', 'P', '1', 0};
+
+PacketCapture::PacketCapture() : Thread("PacketCapture")
+{
+	capturing = false;
+	stream = 0;
+	startTicks = 0;
+
+	//Allocated once, as receiving threads may still be in record when a capture is restarted.
+	//Commit words are only written by producers and zeroed again when consumed, so it starts zeroed.
+	ring.calloc(CAPTURE_RING_SIZE);
+}
+
+PacketCapture::~PacketCapture()
+{
+	stop();
+}
+
+bool PacketCapture::start(const File& CaptureFile)
+{
+	stop();
+
+	CaptureFile.deleteFile();
+	stream = new FileOutputStream(CaptureFile);
+	if (stream->failedToOpen())
+	{
+		deleteAndZero(stream);
+		return false;
+	}
+
+	stream->write(captureMagic, 8);
+	stream->writeInt64(Time::currentTimeMillis());
+
+	//The positions go on from the last capture; records still committed for it are skipped by their time
+	dropped = 0;
+	startTicks = Time::getHighResolutionTicks();
+
+	capturing = true;
+	startThread();
+
+	return true;
+}
+
+void PacketCapture::stop()
+{
+	if (stream == 0)
+		return;
+
+	capturing = false;
+	stopThread(2000);
+
+	deleteAndZero(stream);
+}
+
+void PacketCapture::record(int Port, const IpEndpointName& Source, const char* Data, int Size)
+{
+	if (!capturing)
+		return;
+
+	//Records are 8 byte aligned, so a commit word never wraps around the end of the ring
+	unsigned int length = (CAPTURE_RECORD_HEADER + Size + 7) & ~7;
+	unsigned int position;
+
+	do
+	{
+		position = (unsigned int)reserved.get();
+
+		if (position + length - (unsigned int)consumed.get() > CAPTURE_RING_SIZE)
+		{
+			++dropped;
+			return;
+		}
+	}
+	while (!reserved.compareAndSetBool((int)(position + length), (int)position));
+
+	int64 ticks = Time::getHighResolutionTicks();
+	unsigned short ports[2] = {(unsigned short)Port, (unsigned short)Source.port};
+	unsigned int address = (unsigned int)Source.address;
+
+	copyToRing(position + 4, ports, 4);
+	copyToRing(position + 8, &address, 4);
+	copyToRing(position + 12, &Size, 4);
+	copyToRing(position + 16, &ticks, 8);
+	copyToRing(position + CAPTURE_RECORD_HEADER, Data, Size);
+
+	Atomic<int>::memoryBarrier();
+	*(volatile unsigned int*)(ring + (position & (CAPTURE_RING_SIZE - 1))) = length;
+}
+
+void PacketCapture::run()
+{
+	while (!threadShouldExit())
+	{
+		if (!writeRecords())
+			wait(10);
+	}
+
+	//Records reserved before the capture was stopped are committed shortly after
+	for (int i=0; i<100 && consumed.get() != reserved.get(); i++)
+	{
+		if (!writeRecords())
+			Thread::sleep(1);
+	}
+
+	stream->flush();
+}
+
+bool PacketCapture::writeRecords() //false if there were none
+{
+	unsigned int position = (unsigned int)consumed.get();
+	bool written = false;
+
+	for (;;)
+	{
+		volatile unsigned int* commit = (volatile unsigned int*)(ring + (position & (CAPTURE_RING_SIZE - 1)));
+		unsigned int length = *commit;
+
+		if (length == 0)
+			break;
+
+		Atomic<int>::memoryBarrier();
+
+		unsigned short ports[2];
+		unsigned int address;
+		int size;
+		int64 ticks;
+
+		copyFromRing(position + 4, ports, 4);
+		copyFromRing(position + 8, &address, 4);
+		copyFromRing(position + 12, &size, 4);
+		copyFromRing(position + 16, &ticks, 8);
+
+		//Records received before the capture started belong to the last one
+		if (ticks >= startTicks)
+		{
+			stream->writeInt64(LatencyHistogram::ticksToMicroseconds(ticks - startTicks));
+			stream->writeShort((short)ports[0]);
+			stream->writeShort((short)ports[1]);
+			stream->writeInt((int)address);
+			stream->writeInt(size);
+
+			unsigned int offset = (position + CAPTURE_RECORD_HEADER) & (CAPTURE_RING_SIZE - 1);
+			int first = jmin(size, (int)(CAPTURE_RING_SIZE - offset));
+			stream->write(ring + offset, first);
+			stream->write(ring.getData(), size - first);
+		}
+
+		//Zeroed for the commit words of the records that reuse the space
+		unsigned int offset = position & (CAPTURE_RING_SIZE - 1);
+		int first = jmin((int)length, (int)(CAPTURE_RING_SIZE - offset));
+		zeromem(ring + offset, first);
+		zeromem(ring.getData(), length - first);
+
+		Atomic<int>::memoryBarrier();
+		position += length;
+		consumed = (int)position;
+		written = true;
+	}
+
+	return written;
+}
+
+void PacketCapture::copyToRing(unsigned int Position, const void* Data, int Size)
+{
+	unsigned int offset = Position & (CAPTURE_RING_SIZE - 1);
+	int first = jmin(Size, (int)(CAPTURE_RING_SIZE - offset));
+
+	memcpy(ring + offset, Data, first);
+	memcpy(ring.getData(), (const char*)Data + first, Size - first);
+}
+
+void PacketCapture::copyFromRing(unsigned int Position, void* Data, int Size)
+{
+	unsigned int offset = Position & (CAPTURE_RING_SIZE - 1);
+	int first = jmin(Size, (int)(CAPTURE_RING_SIZE - offset));
+
+	memcpy(Data, ring + offset, first);
+	memcpy((char*)Data + first, ring.getData(), Size - first);
+}
+
+
+CaptureReader::CaptureReader(const File& CaptureFile) : stream(CaptureFile)
+{
+	char magic[8];
+
+	valid = stream.read(magic, 8) == 8 && memcmp(magic, captureMagic, 8) == 0;
+	startTime = valid ? stream.readInt64() : 0;
+}
+
+bool CaptureReader::readNext(CapturedPacket& Packet)
+{
+	//A record cut off at the end of the file (e.g. by a crash) ends the capture
+	if (!valid || stream.getTotalLength() - stream.getPosition() < CAPTURE_FILE_RECORD_HEADER)
+		return false;
+
+	Packet.time = stream.readInt64();
+	Packet.port = (unsigned short)stream.readShort();
+	Packet.source.port = (unsigned short)stream.readShort();
+	Packet.source.address = (unsigned int)stream.readInt();
+
+	int size = stream.readInt();
+	if (size < 0 || size > 65536)
+		return false;
+
+	Packet.data.setSize(size);
+	return stream.read(Packet.data.getData(), size) == size;
+}
+
+
+int replayCapture(const File& CaptureFile, const String& Host, double Speed)
+{
+	CaptureReader reader(CaptureFile);
+	if (!reader.isValid())
+		return -1;
+
+	unsigned long hostAddress = IpEndpointName(Host.toCString()).address;
+
+	map<pair<unsigned int, int>, UdpSocket*> sockets; //by the sender's address and port
+	CapturedPacket packet;
+	double start = Time::getMillisecondCounterHiRes();
+	int count = 0;
+
+	while (reader.readNext(packet))
+	{
+		if (Speed > 0)
+		{
+			double due = start + packet.time / 1000.0 / Speed;
+			double delay = due - Time::getMillisecondCounterHiRes();
+
+			if (delay > 2)
+				Thread::sleep((int)delay - 1);
+
+			while (Time::getMillisecondCounterHiRes() < due)
+				Thread::yield();
+		}
+
+		pair<unsigned int, int> sender = make_pair((unsigned int)packet.source.address, packet.source.port);
+		map<pair<unsigned int, int>, UdpSocket*>::iterator found = sockets.find(sender);
+
+		if (found == sockets.end() && sockets.size() >= MAX_REPLAY_SOCKETS)
+			found = --sockets.end();
+
+		if (found == sockets.end())
+			found = sockets.insert(make_pair(sender, new UdpSocket())).first;
+
+		try
+		{
+			found->second->SendTo(IpEndpointName(hostAddress, packet.port), (const char*)packet.data.getData(), (int)packet.data.getSize());
+			count++;
+		}
+		catch (std::runtime_error&)
+		{
+			//Datagrams the network refuses are skipped, as they would be lost when received
+		}
+	}
+
+	for (map<pair<unsigned int, int>, UdpSocket*>::iterator i = sockets.begin(); i != sockets.end(); ++i)
+		delete i->second;
+
+	return count;
+}
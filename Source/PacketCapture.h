@@ -0,0 +1,92 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "../oscpack/ip/IpEndpointName.h"
+#include "..\juce\juce_amalgamated.h"
+
+#define CAPTURE_RING_SIZE (8 << 20) //bytes, a power of two
+#define CAPTURE_RECORD_HEADER 24 //bytes in the ring before the datagram
+
+//Records the datagrams received by the engine to a file: "OSCCAP1\0" and the start time
+//(int64 ms since 1970), followed by one record per datagram with the time since the start
+//(int64 microseconds), the port and the sender's port (uint16 each), the sender's address
+//(uint32) and the size (int32) of the datagram that follows. All numbers are little endian.
+//
+//Receiving threads reserve space in a ring with a compare and swap and never wait; this
+//thread writes the committed records to the file. Datagrams that don't fit the ring are
+//dropped and counted.
+class PacketCapture : public Thread
+{
+public:
+	PacketCapture();
+	~PacketCapture();
+
+	bool start(const File& CaptureFile);
+	void stop();
+	bool isCapturing() {return capturing;};
+
+	void record(int Port, const IpEndpointName& Source, const char* Data, int Size);
+	int getNumberOfDropped() {return dropped.get();};
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	HeapBlock<char> ring;
+	Atomic<int> reserved; //positions are byte counts modulo 2^32
+	Atomic<int> consumed;
+	Atomic<int> dropped;
+	volatile bool capturing;
+
+	int64 startTicks;
+	FileOutputStream* stream;
+
+	bool writeRecords();
+	void copyFromRing(unsigned int Position, void* Data, int Size);
+	void copyToRing(unsigned int Position, const void* Data, int Size);
+};
+
+struct CapturedPacket
+{
+	int64 time; //microseconds since the start of the capture
+	int port;
+	IpEndpointName source;
+	MemoryBlock data;
+};
+
+class CaptureReader
+{
+public:
+	CaptureReader(const File& CaptureFile);
+
+	bool isValid() {return valid;};
+	int64 getStartTime() {return startTime;}; //ms since 1970
+	bool readNext(CapturedPacket& Packet);
+
+	juce_UseDebuggingNewOperator
+
+private:
+	FileInputStream stream;
+	bool valid;
+	int64 startTime;
+};
+
+//Sends a capture to the ports it was recorded on at Host, keeping the recorded timing divided
+//by Speed, or as fast as possible if Speed is 0. Each sender of the capture gets its own socket,
+//so the datagrams are spread across sockets sharing a port as they were when recorded.
+//Returns the number of datagrams sent, -1 if the file isn't a capture.
+int replayCapture(const File& CaptureFile, const String& Host, double Speed);
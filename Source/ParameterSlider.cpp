@@ -152,7 +152,7 @@ void ParameterSlider::sliderValueChanged (Slider* sliderThatWasMoved)
     if (sliderThatWasMoved == slider)
     {
 		if (!sliderChangedRemotely)
-			((MainComponent*)((CalibratorConfigurator*)getParentComponent())->getCalibratorNode()->getParentComponent())->process();
+			((CalibratorConfigurator*)getParentComponent())->parameterChanged();
     }
 }
 
@@ -190,18 +190,9 @@ void ParameterSlider::setRange(double min, double max, bool minClip, bool maxCli
 
 void ParameterSlider::mouseDrag (const MouseEvent &e)
 {
-	CalibratorConfigurator* configurator= (CalibratorConfigurator*)getParentComponent();
-	vector<ParameterSlider*> sliders = configurator->parameterSliders;
-
-	//find the index of the parameter
-	int index = -1;
-	for (unsigned int i = 0; i<sliders.size(); i++)
-		if (sliders[i] == this)
-			index = i;
-
 	if (e.mods.isLeftButtonDown())
 	{
-		startDragging(String("calibratorremote")+" "+String(index), this, Image::null, true);
+		startDragging(String("calibratorremote")+" "+String(getIndex()), this, Image::null, true);
 	}
 }
 
@@ -215,14 +206,26 @@ void ParameterSlider::mouseUp (const MouseEvent &e)
 
 		if (result==1)
 		{
-			remoteControl=false;
-			remoteNode=0;
-			remoteOutputIndex=-1;
+			((CalibratorConfigurator*)getParentComponent())->configureRemote(getIndex(), false, 0, -1);
 			repaint();
 		}
 	}
 }
 
+int ParameterSlider::getIndex()
+{
+	CalibratorConfigurator* configurator= (CalibratorConfigurator*)getParentComponent();
+	vector<ParameterSlider*> sliders = configurator->parameterSliders;
+
+	//find the index of the parameter
+	int index = -1;
+	for (unsigned int i = 0; i<sliders.size(); i++)
+		if (sliders[i] == this)
+			index = i;
+
+	return index;
+}
+
 void ParameterSlider::setValue(float Value)
 {
 	float min = minEditor->getText().getFloatValue();
@@ -72,6 +72,7 @@ public:
 private:
     //[UserVariables]   -- You can add your own custom variables in this section.
     //[/UserVariables]
+	int getIndex();
 
     //==============================================================================
     Slider* slider;
@@ -0,0 +1,59 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ProfileCounter.h"
+
+ProfileCounter::ProfileCounter()
+{
+	reset();
+}
+
+void ProfileCounter::add(int64 Ticks)
+{
+	calls = calls + 1;
+	totalTicks = totalTicks + Ticks;
+
+	if (Ticks > maxTicks)
+		maxTicks = Ticks;
+}
+
+void ProfileCounter::reset()
+{
+	calls = 0;
+	totalTicks = 0;
+	maxTicks = 0;
+}
+
+double ProfileCounter::getTotalMilliseconds()
+{
+	return totalTicks * 1000.0 / Time::getHighResolutionTicksPerSecond();
+}
+
+double ProfileCounter::getAverageMicroseconds()
+{
+	int n = calls;
+
+	return n > 0 ? totalTicks * 1000000.0 / Time::getHighResolutionTicksPerSecond() / n : 0;
+}
+
+double ProfileCounter::getMaxMicroseconds()
+{
+	return maxTicks * 1000000.0 / Time::getHighResolutionTicksPerSecond();
+}
+
+String ProfileCounter::getSummary()
+{
+	return String(getCalls()) + " calls, avg " + String(getAverageMicroseconds(), 1)
+		+ " us, max " + String(getMaxMicroseconds(), 0) + " us, total " + String(getTotalMilliseconds(), 1) + " ms";
+}
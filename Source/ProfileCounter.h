@@ -0,0 +1,59 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+//Call count, total and maximum time of a piece of code, timed with the high resolution counter
+//(the TSC based performance counter on Windows). Added to by one thread at a time, normally with
+//the engine lock held; other threads may read it without a lock and get a slightly stale value.
+class ProfileCounter
+{
+public:
+	ProfileCounter();
+
+	void add(int64 Ticks);
+	void reset();
+
+	int getCalls() {return calls;};
+	double getTotalMilliseconds();
+	double getAverageMicroseconds();
+	double getMaxMicroseconds();
+
+	//"1200 calls, avg 14 us, max 310 us, total 16.8 ms"
+	String getSummary();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	volatile int calls;
+	volatile int64 totalTicks;
+	volatile int64 maxTicks;
+};
+
+//Adds the time from its construction to its destruction to a counter
+class ScopedProfile
+{
+public:
+	ScopedProfile(ProfileCounter& Counter) : counter(Counter), start(Time::getHighResolutionTicks()) {};
+	~ScopedProfile() {counter.add(Time::getHighResolutionTicks() - start);};
+
+private:
+	ProfileCounter& counter;
+	int64 start;
+
+	ScopedProfile (const ScopedProfile&);
+	const ScopedProfile& operator= (const ScopedProfile&);
+};
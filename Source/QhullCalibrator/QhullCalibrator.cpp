@@ -13,6 +13,27 @@
 
 #include "QhullCalibrator.h"
 
+//Reports a stage of getInterpolated from its construction to its destruction
+class ScopedStage
+{
+public:
+	ScopedStage(QhullCalibratorObserver* Observer, int Stage) : observer(Observer), stage(Stage)
+	{
+		if (observer)
+			observer->stageStarted(stage);
+	}
+
+	~ScopedStage()
+	{
+		if (observer)
+			observer->stageEnded(stage);
+	}
+
+private:
+	QhullCalibratorObserver* observer;
+	int stage;
+};
+
 void QhullCalibrator::addCalibrationPoint(CalibrationPoint cp)
 {
 	vector<double> cpPoint=cp.getPoint();
@@ -103,12 +124,14 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 {
 	if (calibrationPoints.size()==1) //If only one calibration point available, just return its dataset.
 	{
+		lastPath = CALIBRATION_PATH_SINGLE_POINT;
 		lastInterpolationResult = calibrationPoints[0].getData();
 		return lastInterpolationResult;
 	}
 	else if (spaceDimension==1 && calibrationPoints.size()>1) //For single dimensional calibration points, interpolate accordingly  
 	{		
 		//sort(calibrationPoints.begin(), calibrationPoints.end(), &Calibrator::calibrationPointSortPredicate);
+		lastPath = CALIBRATION_PATH_ONE_DIMENSIONAL;
 
 		vector<double> result;
 
@@ -166,6 +189,7 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 	}
 	else if (spaceDimension>1 && calibrationPoints.size()==2) //With only two interpolation points, difining a line, we have to project our point on the line in order to interpolate.
 	{
+		lastPath = CALIBRATION_PATH_LINE;
 		vector<double> result;
 
 		vector<double> lineVector;
@@ -204,6 +228,7 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 	}
 	else if (spaceDimension==3 && calibrationPoints.size()==3) //With only three calibration points, defining a plane, project on the plane to interpolate
 	{
+		lastPath = CALIBRATION_PATH_PLANE;
 		vector<double> result;
 		vector<double> A = calibrationPoints[0].getPoint();
 		vector<double> B = calibrationPoints[1].getPoint();
@@ -249,7 +274,7 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 	}
 	else if (calibrationPoints.size()>(unsigned int)spaceDimension) //If there are enough calibration points, perform a delaunay triangulation and get the corresponding simplex in order to interpolate
 	{
-		
+		lastPath = CALIBRATION_PATH_INTERPOLATION;
 		vector<CalibrationPoint> simplexPoints;
 
 		if (calibrationPoints.size()>(unsigned int)spaceDimension+1)
@@ -267,17 +292,25 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 			unsigned int isoutside[1];
 			isoutside[0] = 0;
 
-			qh_restore_qhull(&qHullConvexContext);
-			qh_findbestfacet(point, !qh_ALL, bestdist, isoutside);
-			qHullConvexContext=qh_save_qhull();
+			{
+				ScopedStage stage(observer, CALIBRATION_STAGE_POINT_LOCATION);
+
+				qh_restore_qhull(&qHullConvexContext);
+				qh_findbestfacet(point, !qh_ALL, bestdist, isoutside);
+				qHullConvexContext=qh_save_qhull();
+			}
 			delete [] point;
 
 			if (isoutside[0])
 			{
+				lastPath = CALIBRATION_PATH_EXTRAPOLATION;
+
+				ScopedStage stage(observer, CALIBRATION_STAGE_EXTRAPOLATION);
 				return getExtrapolated(Point);
 			}
 			else
 			{
+				ScopedStage stage(observer, CALIBRATION_STAGE_SIMPLEX_LOCATION);
 				simplexPoints=getSimplexPoints(Point);
 			}
 		}
@@ -358,6 +391,7 @@ vector<double> QhullCalibrator::getInterpolated(vector<double> Point)
 	}
 	else //just return zeros
 	{
+		lastPath = CALIBRATION_PATH_NONE;
 		vector<double> result;
 
 		for (int i=0; i<dataDimension; i++)
@@ -374,11 +408,49 @@ QhullCalibrator::QhullCalibrator(int SpaceDimension, int DataDimension)
 	dataDimension=DataDimension;
 
 	points = 0;
+	lastPath = CALIBRATION_PATH_NONE;
+	observer = 0;
 
 	qHullContext=0;
 	qHullConvexContext=0;
 }
 
+bool QhullCalibrator::getBounds(vector<double>& Min, vector<double>& Max)
+{
+	if (calibrationPoints.empty())
+		return false;
+
+	Min = calibrationPoints[0].getPoint();
+	Max = Min;
+
+	for (unsigned int i=1; i<calibrationPoints.size(); i++)
+	{
+		vector<double> point = calibrationPoints[i].getPoint();
+
+		for (unsigned int j=0; j<point.size() && j<Min.size(); j++)
+		{
+			Min[j] = std::min(Min[j], point[j]);
+			Max[j] = std::max(Max[j], point[j]);
+		}
+	}
+
+	return true;
+}
+
+const char* QhullCalibrator::getPathName(int Path)
+{
+	static const char* names[NUMBER_OF_CALIBRATION_PATHS] = {"single point", "one dimensional", "line", "plane", "interpolation", "extrapolation", "none"};
+
+	return (Path >= 0 && Path < NUMBER_OF_CALIBRATION_PATHS) ? names[Path] : "";
+}
+
+const char* QhullCalibrator::getStageName(int Stage)
+{
+	static const char* names[NUMBER_OF_CALIBRATION_STAGES] = {"point location", "simplex location", "extrapolation"};
+
+	return (Stage >= 0 && Stage < NUMBER_OF_CALIBRATION_STAGES) ? names[Stage] : "";
+}
+
 QhullCalibrator::~QhullCalibrator(void)
 {
 	for (int i=0; i<simplices.size(); i++)
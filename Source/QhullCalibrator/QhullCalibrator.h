@@ -15,6 +15,32 @@
 
 #include "Simplex.h"
 
+//The ways getInterpolated can find a result, for profiling
+#define CALIBRATION_PATH_SINGLE_POINT 0 //the data of the only calibration point
+#define CALIBRATION_PATH_ONE_DIMENSIONAL 1 //between or beyond the points of a one dimensional space
+#define CALIBRATION_PATH_LINE 2 //projected on the line of two calibration points
+#define CALIBRATION_PATH_PLANE 3 //projected on the plane of three calibration points (3D)
+#define CALIBRATION_PATH_INTERPOLATION 4 //inside a simplex of the triangulation
+#define CALIBRATION_PATH_EXTRAPOLATION 5 //outside the convex hull
+#define CALIBRATION_PATH_NONE 6 //not enough calibration points, zeros
+#define NUMBER_OF_CALIBRATION_PATHS 7
+
+//The costly stages of getInterpolated, reported to its observer for tracing
+#define CALIBRATION_STAGE_POINT_LOCATION 0 //whether the point is inside the convex hull
+#define CALIBRATION_STAGE_SIMPLEX_LOCATION 1 //the simplex of the triangulation containing it
+#define CALIBRATION_STAGE_EXTRAPOLATION 2
+#define NUMBER_OF_CALIBRATION_STAGES 3
+
+//Told when the stages of getInterpolated start and end. Stages don't nest.
+class QhullCalibratorObserver
+{
+public:
+	virtual ~QhullCalibratorObserver() {};
+
+	virtual void stageStarted(int Stage) = 0;
+	virtual void stageEnded(int Stage) = 0;
+};
+
 struct ExtrapolationResult
 {
 	vector<double> values;
@@ -36,6 +62,8 @@ class QhullCalibrator
 	int dataDimension;
 	vector<CalibrationPoint> calibrationPoints;
 	vector<double> lastInterpolationResult;
+	int lastPath;
+	QhullCalibratorObserver* observer;
 
 	double distance(CalibrationPoint A, CalibrationPoint B);
 	vector<CalibrationPoint> getSimplexPoints(vector<double> Point);
@@ -59,8 +87,14 @@ class QhullCalibrator
 public:
 	void addCalibrationPoint(CalibrationPoint cp);
 	vector<double> getInterpolated(vector<double> Point);
+	int getLastPath() {return lastPath;}; //the CALIBRATION_PATH taken by the last getInterpolated call
+	static const char* getPathName(int Path);
+	void setObserver(QhullCalibratorObserver* Observer) {observer=Observer;}; //0 for none
+	static const char* getStageName(int Stage);
 
 	int getNumberOfCalibrationPoints() {return (int)calibrationPoints.size();};
+	//The bounding box of the calibration points in the input space, false if there are none
+	bool getBounds(vector<double>& Min, vector<double>& Max);
 
 	void saveConfiguration(string Filename);
 	void loadConfiguration(string Filename);
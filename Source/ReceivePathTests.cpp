@@ -0,0 +1,141 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "Engine.h"
+#include "OscInputEngineNode.h"
+
+#include <stdlib.h>
+#include <new>
+
+#define TEST_PORT 3333
+#define TEST_PACKETS 1000
+
+//The allocations made by the thread counting them. Every allocation of the application goes
+//through here, so it's no more than a comparison while nothing is counted.
+static volatile bool countingAllocations = false;
+static Thread::ThreadID countingThread = 0;
+static int numberOfAllocations = 0;
+
+static void* allocate(size_t Size)
+{
+	if (countingAllocations && Thread::getCurrentThreadId() == countingThread)
+		numberOfAllocations++;
+
+	void* memory = malloc(Size > 0 ? Size : 1);
+	if (memory == 0)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new(size_t Size) {return allocate(Size);}
+void* operator new[](size_t Size) {return allocate(Size);}
+void operator delete(void* Memory) throw() {free(Memory);}
+void operator delete[](void* Memory) throw() {free(Memory);}
+
+//Drives a PortListener without a socket, as the rings and TCP connections do, with a literal
+//receiver applied on the receiving thread and a wildcard receiver with a queue
+class ReceivePathTests : public UnitTest
+{
+public:
+	ReceivePathTests() : UnitTest("Receive path") {}
+
+	void runTest()
+	{
+		Engine engine;
+
+		OscInputEngineNode* literal = new OscInputEngineNode();
+		literal->setNumberOfOutputs(2);
+		engine.addNode(literal);
+
+		OscInputEngineNode* wildcard = new OscInputEngineNode();
+		wildcard->setNumberOfOutputs(4);
+		engine.addNode(wildcard);
+
+		engine.oscManager.registerReceiver("/test/value", 2, TEST_PORT, String::empty, false, String::empty, literal);
+		engine.oscManager.registerReceiver("/test/*", 4, TEST_PORT, String::empty, false, String::empty, wildcard);
+		engine.oscManager.setQueuePolicy(wildcard, QUEUE_LATEST, 4);
+
+		PortListener listener(&engine.oscManager.receivers, &engine.oscManager.dispatchTable, TEST_PORT, &engine);
+
+		char message[256];
+		osc::OutboundPacketStream m(message, sizeof(message));
+		m << osc::BeginMessage("/test/value") << 0.25f << 0.5f << osc::EndMessage;
+
+		char bundle[256];
+		osc::OutboundPacketStream b(bundle, sizeof(bundle));
+		b << osc::BeginBundleImmediate
+			<< osc::BeginMessage("/test/value") << 1.0f << 2.0f << osc::EndMessage
+			<< osc::BeginMessage("/test/other") << 3.0f << 4.0f << 5.0f << 6.0f << osc::EndMessage
+			<< osc::EndBundle;
+
+		beginTest("Messages reach the literal and the wildcard receiver");
+
+		listener.ProcessPacket(m.Data(), (int)m.Size(), IpEndpointName());
+		expectEquals(literal->getOutputValue(1), 0.5f);
+
+		float values[4];
+		int64 receiveTicks;
+		ReceiverQueue* queue = getQueue(engine, wildcard);
+		expect(queue != 0 && queue->pop(values, 4, receiveTicks), "the wildcard receiver has no queued values");
+		expectEquals(values[1], 0.5f);
+		expectEquals(values[2], 0.0f);
+
+		for (int bundleFrames=0; bundleFrames<2; bundleFrames++)
+		{
+			engine.oscManager.setBundleFrames(bundleFrames != 0);
+
+			beginTest(bundleFrames ? "Dispatching doesn't allocate, with bundle frames" : "Dispatching doesn't allocate");
+
+			//The first packets size the buffers that are reused
+			dispatch(listener, m, b, 10);
+
+			countingThread = Thread::getCurrentThreadId();
+			numberOfAllocations = 0;
+			countingAllocations = true;
+
+			dispatch(listener, m, b, TEST_PACKETS);
+
+			countingAllocations = false;
+
+			expectEquals(numberOfAllocations, 0);
+			expectEquals(literal->getOutputValue(0), 1.0f);
+		}
+	}
+
+	juce_UseDebuggingNewOperator
+
+private:
+	void dispatch(PortListener& Listener, osc::OutboundPacketStream& Message, osc::OutboundPacketStream& Bundle, int Count)
+	{
+		for (int i=0; i<Count; i++)
+		{
+			Listener.ProcessPacket(Message.Data(), (int)Message.Size(), IpEndpointName());
+			Listener.ProcessPacket(Bundle.Data(), (int)Bundle.Size(), IpEndpointName());
+		}
+	}
+
+	ReceiverQueue* getQueue(Engine& TheEngine, EngineNode* ReceiverNode)
+	{
+		vector<ReceiverRegistration>& receivers = TheEngine.oscManager.receivers;
+
+		for (unsigned int i=0; i<receivers.size(); i++)
+			if (receivers[i].receiverNode == ReceiverNode)
+				return receivers[i].queue;
+
+		return 0;
+	}
+};
+
+static ReceivePathTests receivePathTests;
@@ -0,0 +1,78 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "ReceiverQueue.h"
+
+ReceiverQueue::ReceiverQueue(int Policy, int Capacity, int NumberOfValues)
+{
+	policy = Policy;
+	capacity = (Policy == QUEUE_LATEST) ? 1 : jmax(1, Capacity);
+	numberOfValues = jmax(1, NumberOfValues);
+
+	slots.resize(capacity * numberOfValues);
+	receiveTicks.resize(capacity);
+	first = 0;
+	count = 0;
+}
+
+ReceiverQueue::~ReceiverQueue()
+{
+
+}
+
+void ReceiverQueue::push(const osc::ReceivedMessage& m, int64 ReceiveTicks)
+{
+	const ScopedLock myScopedLock (cs);
+
+	//A full queue makes room by dropping its oldest values
+	if (count == capacity)
+	{
+		first = (first + 1) % capacity;
+		count--;
+		++dropped;
+	}
+
+	int slot = (first + count) % capacity;
+	float* values = &slots[slot * numberOfValues];
+	receiveTicks[slot] = ReceiveTicks;
+
+	unsigned long numberOfArguments = m.ReadFloatArguments(values, numberOfValues);
+	for (int j=(int)numberOfArguments; j<numberOfValues; j++)
+		values[j] = 0;
+
+	count++;
+}
+
+bool ReceiverQueue::pop(float* Values, int NumberOfValues, int64& ReceiveTicks)
+{
+	const ScopedLock myScopedLock (cs);
+
+	if (count == 0)
+		return false;
+
+	const float* values = &slots[first * numberOfValues];
+
+	int j=0;
+	for (; j<jmin(NumberOfValues, numberOfValues); j++)
+		Values[j] = values[j];
+	for (; j<NumberOfValues; j++)
+		Values[j] = 0;
+
+	ReceiveTicks = receiveTicks[first];
+
+	first = (first + 1) % capacity;
+	count--;
+
+	return true;
+}
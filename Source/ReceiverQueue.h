@@ -0,0 +1,65 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "../oscpack/osc/OscReceivedElements.h"
+#include "..\juce\juce_amalgamated.h"
+
+#include <vector>
+using namespace std;
+
+#define QUEUE_ALL 0 //every message is applied and evaluated on the receiving thread
+#define QUEUE_LATEST 1 //pending values are overwritten, only the freshest is evaluated
+#define QUEUE_BOUNDED 2 //pending values are evaluated in order, the oldest dropped on overflow
+
+//The values received for one receiver that haven't been evaluated yet. Receiving threads push
+//the arguments of matching messages, the OscManager thread pops them, so receiving never waits
+//for the graph evaluation and the pending data is bounded by the capacity.
+class ReceiverQueue
+{
+public:
+	ReceiverQueue(int Policy, int Capacity, int NumberOfValues);
+	~ReceiverQueue();
+
+	int getPolicy() {return policy;};
+	int getCapacity() {return capacity;};
+
+	void push(const osc::ReceivedMessage& m, int64 ReceiveTicks);
+
+	//Copies the oldest pending values into Values (missing ones read as 0) and their receive
+	//time into ReceiveTicks, false if none
+	bool pop(float* Values, int NumberOfValues, int64& ReceiveTicks);
+
+	//Messages overwritten or dropped before they were evaluated
+	int getNumberOfDropped() {return dropped.get();};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	int policy;
+	int capacity;
+	int numberOfValues;
+
+	vector<float> slots; //capacity slots of numberOfValues each
+	vector<int64> receiveTicks; //one per slot
+	int first; //the slot of the oldest pending values
+	int count;
+	Atomic<int> dropped;
+
+	CriticalSection cs;
+
+	ReceiverQueue (const ReceiverQueue&);
+	const ReceiverQueue& operator= (const ReceiverQueue&);
+};
@@ -0,0 +1,101 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SharedMemory.h"
+
+#if JUCE_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::SharedMemory()
+{
+	data = 0;
+	size = 0;
+	handle = 0;
+}
+
+SharedMemory::~SharedMemory()
+{
+	close();
+}
+
+bool SharedMemory::open(const String& Name, size_t Size)
+{
+	close();
+
+#if JUCE_WINDOWS
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0, PAGE_READWRITE, 0, (DWORD)Size, ("Local\\" + Name).toCString());
+	if (mapping == 0)
+		return false;
+
+	void* memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (memory == 0)
+	{
+		CloseHandle(mapping);
+		return false;
+	}
+
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(memory, &info, sizeof(info));
+	Size = info.RegionSize;
+
+	handle = mapping;
+#else
+	int fd = shm_open(("/" + Name).toCString(), O_RDWR | O_CREAT, 0600);
+	if (fd == -1)
+		return false;
+
+	struct stat status;
+	if (fstat(fd, &status) == 0 && status.st_size > 0)
+		Size = (size_t)status.st_size;
+	else if (ftruncate(fd, Size) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* memory = mmap(0, Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (memory == MAP_FAILED)
+		return false;
+#endif
+
+	data = (char*)memory;
+	size = Size;
+
+	return true;
+}
+
+void SharedMemory::close()
+{
+	if (data == 0)
+		return;
+
+#if JUCE_WINDOWS
+	UnmapViewOfFile(data);
+	CloseHandle((HANDLE)handle);
+#else
+	munmap(data, size);
+#endif
+
+	data = 0;
+	size = 0;
+	handle = 0;
+}
@@ -0,0 +1,45 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+//Named memory shared with other processes on this machine, called "/name" (shm_open) or
+//"Local\name" (CreateFileMapping). Only the same user may open memory this process creates.
+class SharedMemory
+{
+public:
+	SharedMemory();
+	~SharedMemory();
+
+	//Maps the memory, creating it with Size bytes if it doesn't exist yet. Existing memory is
+	//mapped whole, whatever its size. False if it can't be mapped.
+	bool open(const String& Name, size_t Size);
+	void close();
+	bool isOpen() {return data != 0;};
+
+	char* getData() {return data;};
+	size_t getSize() {return size;};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	char* data;
+	size_t size;
+	void* handle;
+
+	SharedMemory (const SharedMemory&);
+	const SharedMemory& operator= (const SharedMemory&);
+};
@@ -0,0 +1,170 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SharedMemoryRing.h"
+
+#define RING_MAGIC 0x5243534F //"OSCR"
+#define RING_INITIALISING 1
+#define RING_WRAP 0xFFFFFFFF
+#define RING_MIN_CAPACITY 8 //bytes, room for the smallest record and a wrap marker
+
+SharedMemoryRing::SharedMemoryRing()
+{
+	header = 0;
+	data = 0;
+	capacity = 0;
+	pendingRead = 0;
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+	close();
+}
+
+//Positions are mapped into the ring with capacity - 1 as a mask
+static bool isValidCapacity(uint32 Capacity)
+{
+	return Capacity >= RING_MIN_CAPACITY && (Capacity & (Capacity - 1)) == 0;
+}
+
+bool SharedMemoryRing::open(const String& Name, int Capacity)
+{
+	close();
+
+	if (Capacity <= 0 || !isValidCapacity((uint32)Capacity))
+		return false;
+
+	if (!memory.open(Name, sizeof(Header) + Capacity))
+		return false;
+
+	header = (Header*)memory.getData();
+	data = memory.getData() + sizeof(Header);
+
+	//A new ring is zero filled; whichever side comes first initialises it
+	if (header->magic.compareAndSetBool(RING_INITIALISING, 0))
+	{
+		header->capacity = (uint32)Capacity;
+		header->writePosition = 0;
+		header->readPosition = 0;
+		Atomic<int>::memoryBarrier();
+		header->magic = RING_MAGIC;
+	}
+
+	for (int i=0; i<100 && header->magic.get() == RING_INITIALISING; i++)
+		Thread::sleep(1);
+
+	//The capacity of an existing ring comes from the other process
+	if (header->magic.get() != RING_MAGIC || !isValidCapacity(header->capacity) || sizeof(Header) + header->capacity > memory.getSize())
+	{
+		close();
+		return false;
+	}
+
+	capacity = header->capacity;
+	pendingRead = header->readPosition;
+
+	return true;
+}
+
+void SharedMemoryRing::close()
+{
+	memory.close();
+
+	header = 0;
+	data = 0;
+}
+
+bool SharedMemoryRing::write(const char* Data, int Size)
+{
+	const uint32 recordSize = 4 + ((Size + 3) & ~3);
+
+	uint32 position = header->writePosition;
+	uint32 offset = position & (capacity - 1);
+
+	//A packet doesn't wrap: the rest of the ring is skipped instead
+	uint32 skipped = 0;
+	if (capacity - offset < recordSize)
+		skipped = capacity - offset;
+
+	const uint32 used = position - header->readPosition;
+	if (used + skipped + recordSize > capacity)
+		return false;
+
+	if (skipped)
+	{
+		*(uint32*)(data + offset) = RING_WRAP;
+		position += skipped;
+		offset = 0;
+	}
+
+	*(uint32*)(data + offset) = (uint32)Size;
+	memcpy(data + offset + 4, Data, Size);
+
+	//The packet has to be complete before the reader sees the new position
+	Atomic<int>::memoryBarrier();
+	header->writePosition = position + recordSize;
+
+	return true;
+}
+
+const char* SharedMemoryRing::read(int& Size)
+{
+	uint32 position = header->readPosition;
+	const uint32 writePosition = header->writePosition;
+	Atomic<int>::memoryBarrier();
+
+	if (position == writePosition)
+		return 0;
+
+	uint32 offset = position & (capacity - 1);
+	uint32 size = *(uint32*)(data + offset);
+
+	if (size == RING_WRAP)
+	{
+		//The skipped space must have been written as well
+		if (capacity - offset > writePosition - position)
+		{
+			header->readPosition = writePosition;
+			return 0;
+		}
+
+		position += capacity - offset;
+		offset = 0;
+
+		if (position == writePosition)
+			return 0;
+
+		size = *(uint32*)(data + offset);
+	}
+
+	//A packet that doesn't fit before the end of the ring or reaches past what has been written
+	//means the producer doesn't follow the format: skip everything
+	if (size > capacity - offset - 4 || 4 + ((size + 3) & ~3) > writePosition - position)
+	{
+		header->readPosition = writePosition;
+		return 0;
+	}
+
+	Size = (int)size;
+	pendingRead = position + 4 + ((size + 3) & ~3);
+
+	return data + offset + 4;
+}
+
+void SharedMemoryRing::release()
+{
+	//The packet has been used up before the writer may overwrite it
+	Atomic<int>::memoryBarrier();
+	header->readPosition = pendingRead;
+}
@@ -0,0 +1,73 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "SharedMemory.h"
+
+//A lock-free ring of OSC packets in named shared memory, for producers and consumers on the
+//same machine ("shm://name" addresses). There is one writer and one reader per ring.
+//
+//The memory (see SharedMemory for its name) starts with a 192 byte header: the magic "OSCR" and the capacity as uint32 at 0 and 4, the write
+//position at 64 and the read position at 128, both uint32 byte counts that wrap around. The
+//packets follow as a uint32 size and the packet padded to 4 bytes. A size of 0xFFFFFFFF
+//means the rest of the ring is unused and the next packet starts at its beginning. All
+//values are in host byte order; the packets themselves are ordinary OSC packets.
+class SharedMemoryRing
+{
+public:
+	SharedMemoryRing();
+	~SharedMemoryRing();
+
+	//Maps the ring, creating it if neither side has yet. Capacity (a power of two, at least 8)
+	//only applies to a new ring. False if the memory can't be mapped, or if the capacity given
+	//or found in an existing ring isn't valid.
+	bool open(const String& Name, int Capacity = 1 << 20);
+	void close();
+	bool isOpen() {return memory.isOpen();};
+
+	//Producer: false if there isn't enough room, in which case the packet is dropped
+	bool write(const char* Data, int Size);
+
+	//Consumer: the next packet, or 0 if the ring is empty. It stays valid until release().
+	const char* read(int& Size);
+	void release();
+
+	static bool isRingAddress(const String& Address) {return Address.startsWith("shm://");};
+	static String getRingName(const String& Address) {return Address.substring(6);};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	struct Header
+	{
+		Atomic<int> magic;
+		uint32 capacity;
+		uint32 padding1[14];
+		volatile uint32 writePosition;
+		uint32 padding2[15];
+		volatile uint32 readPosition;
+		uint32 padding3[15];
+	};
+
+	SharedMemory memory;
+	Header* header;
+	char* data;
+	uint32 capacity; //validated when the ring is opened; the header's copy isn't trusted after that
+	uint32 pendingRead; //the read position after the packet returned by read()
+
+	SharedMemoryRing (const SharedMemoryRing&);
+	const SharedMemoryRing& operator= (const SharedMemoryRing&);
+};
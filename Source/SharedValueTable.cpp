@@ -0,0 +1,94 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SharedValueTable.h"
+
+#define TABLE_MAGIC 0x5453434F //"OSCT"
+#define TABLE_NAME_LENGTH 48
+
+SharedValueTable::SharedValueTable()
+{
+	header = 0;
+	names = 0;
+	values = 0;
+	capacity = 0;
+}
+
+SharedValueTable::~SharedValueTable()
+{
+	close();
+}
+
+bool SharedValueTable::open(const String& Name, int Capacity)
+{
+	close();
+
+	if (!memory.open(Name, sizeof(Header) + Capacity * (TABLE_NAME_LENGTH + sizeof(float))))
+		return false;
+
+	name = Name;
+	header = (Header*)memory.getData();
+
+	//A table left over from an earlier run may have another size: it's reused as far as it goes
+	capacity = (int)((memory.getSize() - sizeof(Header)) / (TABLE_NAME_LENGTH + sizeof(float)));
+	names = memory.getData() + sizeof(Header);
+	values = (float*)(names + capacity * TABLE_NAME_LENGTH);
+
+	header->sequence = header->sequence | 1;
+	Atomic<int>::memoryBarrier();
+
+	header->capacity = (uint32)capacity;
+	header->numberOfEntries = 0;
+	header->magic = TABLE_MAGIC;
+
+	Atomic<int>::memoryBarrier();
+	header->sequence = header->sequence + 1;
+
+	return true;
+}
+
+void SharedValueTable::close()
+{
+	memory.close();
+
+	name = String::empty;
+	header = 0;
+	names = 0;
+	values = 0;
+	capacity = 0;
+}
+
+void SharedValueTable::beginWrite()
+{
+	header->sequence = header->sequence + 1;
+	Atomic<int>::memoryBarrier();
+}
+
+void SharedValueTable::endWrite()
+{
+	Atomic<int>::memoryBarrier();
+	header->sequence = header->sequence + 1;
+}
+
+void SharedValueTable::setNumberOfEntries(int NumberOfEntries)
+{
+	header->numberOfEntries = (uint32)NumberOfEntries;
+}
+
+void SharedValueTable::setEntryName(int Index, const String& EntryName)
+{
+	char* entry = names + Index * TABLE_NAME_LENGTH;
+
+	EntryName.copyToCString(entry, TABLE_NAME_LENGTH);
+}
@@ -0,0 +1,71 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+#include "SharedMemory.h"
+
+//The latest values of all node outputs in shared memory, rewritten by the engine after every
+//processing pass. Any number of local processes can read it without costing the engine anything.
+//
+//The memory (see SharedMemory for its name) starts with a 64 byte header: the magic "OSCT",
+//the capacity, the sequence number and the number of entries as uint32 at 0, 4, 8 and 12. Then
+//come the entry names, 48 bytes each and zero terminated, and then the values as floats, all in
+//host byte order. The sequence number is odd while the table is being written. Readers copy
+//what they need while it is even and try again if it has changed in the meantime (a seqlock).
+class SharedValueTable
+{
+public:
+	SharedValueTable();
+	~SharedValueTable();
+
+	//Maps the table, creating it for Capacity entries if it doesn't exist yet
+	bool open(const String& Name, int Capacity = 4096);
+	void close();
+	bool isOpen() {return memory.isOpen();};
+	const String& getName() {return name;};
+
+	int getCapacity() {return capacity;};
+
+	//Changes are only made between these two
+	void beginWrite();
+	void endWrite();
+
+	void setNumberOfEntries(int NumberOfEntries);
+	void setEntryName(int Index, const String& EntryName);
+	void setValue(int Index, float Value) {values[Index]=Value;};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	struct Header
+	{
+		uint32 magic;
+		uint32 capacity;
+		volatile uint32 sequence;
+		volatile uint32 numberOfEntries;
+		uint32 padding[12];
+	};
+
+	SharedMemory memory;
+	String name;
+	Header* header;
+	char* names;
+	float* values;
+	int capacity;
+
+	SharedValueTable (const SharedValueTable&);
+	const SharedValueTable& operator= (const SharedValueTable&);
+};
@@ -0,0 +1,283 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "SlipTcp.h"
+#include "TraceRecorder.h"
+#include "../oscpack/osc/OscException.h"
+
+#define SLIP_END ((char)0xC0)
+#define SLIP_ESC ((char)0xDB)
+#define SLIP_ESC_END ((char)0xDC)
+#define SLIP_ESC_ESC ((char)0xDD)
+
+#define TCP_READ_SIZE 65536
+#define TCP_MAX_PENDING (4 << 20) //bytes buffered for a receiver that doesn't keep up
+#define SLIP_MAX_FRAME 65536 //bytes, longer frames are dropped up to their END
+
+SlipCodec::SlipCodec()
+{
+	escaped = false;
+	overlong = false;
+}
+
+void SlipCodec::encode(vector<char>& Stream, const char* Data, int Size)
+{
+	Stream.push_back(SLIP_END);
+
+	for (int i=0; i<Size; i++)
+	{
+		if (Data[i] == SLIP_END)
+		{
+			Stream.push_back(SLIP_ESC);
+			Stream.push_back(SLIP_ESC_END);
+		}
+		else if (Data[i] == SLIP_ESC)
+		{
+			Stream.push_back(SLIP_ESC);
+			Stream.push_back(SLIP_ESC_ESC);
+		}
+		else
+			Stream.push_back(Data[i]);
+	}
+
+	Stream.push_back(SLIP_END);
+}
+
+void SlipCodec::decode(const char* Data, int Size, PacketListener* Listener, const IpEndpointName& Sender)
+{
+	for (int i=0; i<Size; i++)
+	{
+		char c = Data[i];
+
+		//A peer that never ends its frame can't make it grow without bound
+		if (overlong)
+		{
+			if (c == SLIP_END)
+				overlong = false;
+
+			continue;
+		}
+
+		if ((int)frame.size() >= SLIP_MAX_FRAME && c != SLIP_END)
+		{
+			frame.clear();
+			escaped = false;
+			overlong = true;
+			continue;
+		}
+
+		if (escaped)
+		{
+			frame.push_back(c == SLIP_ESC_END ? SLIP_END : (c == SLIP_ESC_ESC ? SLIP_ESC : c));
+			escaped = false;
+		}
+		else if (c == SLIP_ESC)
+			escaped = true;
+		else if (c != SLIP_END)
+			frame.push_back(c);
+		else if (!frame.empty())
+		{
+			try
+			{
+				Listener->ProcessPacket(&frame[0], (int)frame.size(), Sender);
+			}
+			catch (osc::Exception&)
+			{
+				//Malformed packets are dropped
+			}
+
+			frame.clear();
+		}
+	}
+}
+
+void SlipCodec::reset()
+{
+	frame.clear();
+	escaped = false;
+	overlong = false;
+}
+
+
+TcpSender::TcpSender(const String& Host, int Port) : Thread("TcpSender")
+{
+	host = Host;
+	port = Port;
+	dropped = 0;
+	reportedDropped = 0;
+}
+
+TcpSender::~TcpSender()
+{
+	stopThread(2000);
+}
+
+void TcpSender::send(const char* const* Data, const int* Sizes, int Count)
+{
+	{
+		const ScopedLock myScopedLock (cs);
+
+		if ((int)pending.size() > TCP_MAX_PENDING)
+		{
+			dropped += Count;
+			return;
+		}
+
+		for (int i=0; i<Count; i++)
+			SlipCodec::encode(pending, Data[i], Sizes[i]);
+	}
+
+	notify();
+}
+
+void TcpSender::run()
+{
+	while (!threadShouldExit())
+	{
+		if (!socket.isConnected())
+		{
+			if (!socket.connect(host, port, 1000))
+			{
+				wait(1000);
+				continue;
+			}
+
+			//A new connection starts with the current packets, not a backlog
+			const ScopedLock myScopedLock (cs);
+			pending.clear();
+		}
+
+		int newlyDropped;
+		{
+			const ScopedLock myScopedLock (cs);
+			writing.swap(pending);
+
+			newlyDropped = dropped - reportedDropped;
+			reportedDropped = dropped;
+		}
+
+		if (newlyDropped > 0)
+			Logger::writeToLog("OscCalibrator: dropped " + String(newlyDropped) + " packets to tcp://" + host + ":" + String(port)
+				+ ", the receiver doesn't keep up");
+
+		if (writing.empty())
+		{
+			wait(100);
+			continue;
+		}
+
+		int written = 0;
+		while (written < (int)writing.size() && !threadShouldExit())
+		{
+			int ready = socket.waitUntilReady(false, 100);
+			if (ready < 0)
+				break;
+			if (ready == 0)
+				continue;
+
+			int result = socket.write(&writing[written], (int)writing.size() - written);
+			if (result < 0)
+				break;
+
+			written += result;
+		}
+
+		if (written < (int)writing.size() && !threadShouldExit())
+		{
+			Logger::writeToLog("OscCalibrator: lost the connection to tcp://" + host + ":" + String(port));
+			socket.close();
+		}
+
+		writing.clear();
+	}
+
+	socket.close();
+}
+
+
+TcpConnection::TcpConnection(StreamingSocket* Socket, PacketListener* Listener) : Thread("TcpConnection")
+{
+	socket = Socket;
+	listener = Listener;
+	buffer.malloc(TCP_READ_SIZE);
+}
+
+TcpConnection::~TcpConnection()
+{
+	stopThread(500);
+	delete socket;
+}
+
+void TcpConnection::run()
+{
+	TraceThread traceThread;
+
+	IpEndpointName sender;
+
+	while (!threadShouldExit())
+	{
+		int ready = socket->waitUntilReady(true, 100);
+		if (ready < 0)
+			break;
+		if (ready == 0)
+			continue;
+
+		int size = socket->read(buffer, TCP_READ_SIZE, false);
+		if (size <= 0)
+			break;
+
+		codec.decode(buffer, size, listener, sender);
+	}
+}
+
+
+TcpReceiver::TcpReceiver(int Port, PacketListener* Listener) : Thread("TcpReceiver")
+{
+	port = Port;
+	listener = Listener;
+}
+
+TcpReceiver::~TcpReceiver()
+{
+	signalThreadShouldExit();
+	socket.close(); //interrupts waiting for the next connection
+	stopThread(2000);
+
+	connections.clear();
+	delete listener;
+}
+
+bool TcpReceiver::open()
+{
+	return socket.createListener(port);
+}
+
+void TcpReceiver::run()
+{
+	while (!threadShouldExit())
+	{
+		StreamingSocket* connection = socket.waitForNextConnection();
+		if (connection == 0)
+			break;
+
+		//Connections that have ended are cleaned up with each new one
+		for (int i=connections.size()-1; i>=0; i--)
+			if (connections[i]->isFinished())
+				connections.remove(i);
+
+		TcpConnection* tcpConnection = new TcpConnection(connection, listener);
+		connections.add(tcpConnection);
+		tcpConnection->startThread();
+	}
+}
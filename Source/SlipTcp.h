@@ -0,0 +1,119 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "../oscpack/ip/PacketListener.h"
+#include "../oscpack/ip/IpEndpointName.h"
+
+#include "..\juce\juce_amalgamated.h"
+
+#include <vector>
+using namespace std;
+
+//OSC 1.1 stream framing (SLIP, RFC 1055): every packet is sent between two END bytes, with END
+//and ESC bytes inside it escaped. Used for "tcp://" inputs and outputs.
+class SlipCodec
+{
+public:
+	SlipCodec();
+
+	//Appends one framed packet
+	static void encode(vector<char>& Stream, const char* Data, int Size);
+
+	//Passes every packet completed by these bytes of the stream to Listener
+	void decode(const char* Data, int Size, PacketListener* Listener, const IpEndpointName& Sender);
+	void reset();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	vector<char> frame;
+	bool escaped;
+	bool overlong; //dropping the rest of a frame that got too long
+};
+
+//Sends the packets of an output destination over TCP. The engine only appends framed packets
+//to a buffer; this thread connects (retrying every second) and writes them, so a slow or
+//missing receiver never blocks processing. All packets of a pass go out with one write.
+class TcpSender : public Thread
+{
+public:
+	TcpSender(const String& Host, int Port);
+	~TcpSender();
+
+	void send(const char* const* Data, const int* Sizes, int Count);
+
+	void run();
+
+	//"tcp://host" for outputs, "tcp://port" for inputs
+	static bool isTcpAddress(const String& Address) {return Address.startsWith("tcp://");};
+	static String getTcpName(const String& Address) {return Address.substring(6);};
+
+	juce_UseDebuggingNewOperator
+
+private:
+	String host;
+	int port;
+	StreamingSocket socket;
+
+	vector<char> pending; //framed packets waiting for the thread
+	vector<char> writing; //the bytes being written by the thread
+	int dropped; //packets dropped because the buffer was full
+	int reportedDropped; //of those, already logged by the thread
+
+	CriticalSection cs;
+};
+
+//One accepted connection of a TcpReceiver: reads whatever has arrived with each wakeup and
+//dispatches all complete packets in it
+class TcpConnection : public Thread
+{
+public:
+	TcpConnection(StreamingSocket* Socket, PacketListener* Listener);
+	~TcpConnection();
+
+	bool isFinished() {return !isThreadRunning();};
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	StreamingSocket* socket;
+	PacketListener* listener;
+	SlipCodec codec;
+	HeapBlock<char> buffer;
+};
+
+//Accepts TCP connections on a port and passes their packets to its listener
+class TcpReceiver : public Thread
+{
+public:
+	TcpReceiver(int Port, PacketListener* Listener);
+	~TcpReceiver();
+
+	bool open();
+	int getPort() {return port;};
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	int port;
+	StreamingSocket socket;
+	PacketListener* listener;
+	OwnedArray<TcpConnection> connections;
+};
@@ -0,0 +1,227 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "TraceRecorder.h"
+
+#if JUCE_MSVC
+	#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+	#define TRACE_THREAD_LOCAL __thread
+#endif
+
+struct TraceEvent
+{
+	const char* name;
+	int64 start;
+	int64 end;
+	int id;
+};
+
+//Written only by its thread. A buffer is kept until its thread releases it (see TraceThread), and
+//after that until the trace with its events is written.
+struct TraceBuffer
+{
+	int threadId; //sequential, as shown in the trace
+	String threadName;
+	HeapBlock<TraceEvent> events;
+	volatile int count;
+	volatile int dropped;
+	bool finished; //released by its thread
+};
+
+static CriticalSection buffersLock;
+static OwnedArray<TraceBuffer> buffers;
+static int nextThreadId = 1;
+static TRACE_THREAD_LOCAL TraceBuffer* threadBuffer = 0;
+
+volatile bool TraceRecorder::recording = false;
+bool TraceRecorder::collecting = false;
+
+TraceRecorder::TraceRecorder() : Thread("TraceRecorder")
+{
+	seconds = 0;
+	startTicks = 0;
+}
+
+TraceRecorder::~TraceRecorder()
+{
+	stop();
+}
+
+bool TraceRecorder::start(const File& TraceFile, double Seconds)
+{
+	if (isThreadRunning())
+		return false;
+
+	TraceFile.deleteFile();
+	if (!TraceFile.create())
+		return false;
+
+	traceFile = TraceFile;
+	seconds = Seconds;
+
+	{
+		const ScopedLock myScopedLock (buffersLock);
+
+		for (int i=0; i<buffers.size(); i++)
+		{
+			buffers[i]->count = 0;
+			buffers[i]->dropped = 0;
+		}
+
+		collecting = true;
+	}
+
+	startTicks = Time::getHighResolutionTicks();
+	recording = true;
+
+	startThread();
+	return true;
+}
+
+void TraceRecorder::stop()
+{
+	//The thread writes the trace once it's woken up
+	stopThread(10000);
+}
+
+void TraceRecorder::run()
+{
+	wait(jmax(1, (int)(seconds * 1000)));
+
+	recording = false;
+
+	//Events that were being added when recording stopped are completed by now
+	Thread::sleep(10);
+
+	writeTrace();
+	releaseFinishedBuffers();
+}
+
+void TraceRecorder::releaseFinishedBuffers()
+{
+	const ScopedLock myScopedLock (buffersLock);
+
+	for (int i=buffers.size()-1; i>=0; i--)
+		if (buffers[i]->finished)
+			buffers.remove(i);
+
+	collecting = false;
+}
+
+void TraceRecorder::releaseThreadBuffer()
+{
+	TraceBuffer* buffer = threadBuffer;
+	if (buffer == 0)
+		return;
+
+	threadBuffer = 0;
+
+	const ScopedLock myScopedLock (buffersLock);
+
+	if (collecting && buffer->count > 0)
+		buffer->finished = true;
+	else
+		buffers.removeObject(buffer);
+}
+
+void TraceRecorder::addEvent(const char* Name, int64 Start, int64 End, int Id)
+{
+	TraceBuffer* buffer = threadBuffer;
+
+	if (buffer == 0)
+	{
+		buffer = new TraceBuffer();
+		buffer->events.allocate(TRACE_EVENTS_PER_THREAD, false);
+		buffer->count = 0;
+		buffer->dropped = 0;
+		buffer->finished = false;
+
+		Thread* thread = Thread::getCurrentThread();
+		buffer->threadName = thread != 0 ? thread->getThreadName() : String("main");
+
+		const ScopedLock myScopedLock (buffersLock);
+
+		buffer->threadId = nextThreadId++;
+		buffers.add(buffer);
+		threadBuffer = buffer;
+	}
+
+	int count = buffer->count;
+	if (count == TRACE_EVENTS_PER_THREAD)
+	{
+		buffer->dropped = buffer->dropped + 1;
+		return;
+	}
+
+	TraceEvent& event = buffer->events[count];
+	event.name = Name;
+	event.start = Start;
+	event.end = End;
+	event.id = Id;
+
+	buffer->count = count + 1;
+}
+
+void TraceRecorder::writeTrace()
+{
+	FileOutputStream stream (traceFile);
+	if (stream.failedToOpen())
+	{
+		Logger::writeToLog("OscCalibrator: unable to write the trace " + traceFile.getFullPathName());
+		return;
+	}
+
+	double ticksPerMicrosecond = Time::getHighResolutionTicksPerSecond() / 1000000.0;
+	int numberOfEvents = 0;
+	int numberOfDropped = 0;
+
+	stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	const ScopedLock myScopedLock (buffersLock);
+
+	for (int i=0; i<buffers.size(); i++)
+	{
+		TraceBuffer* buffer = buffers[i];
+
+		if (buffer->count == 0)
+			continue;
+
+		stream << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << String(buffer->threadId)
+			<< ", \"args\": {\"name\": \"" << buffer->threadName << "\"}},\n";
+
+		for (int j=0; j<buffer->count; j++)
+		{
+			const TraceEvent& event = buffer->events[j];
+
+			stream << "{\"name\": \"" << event.name << "\", \"cat\": \"osccalibrator\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << String(buffer->threadId)
+				<< ", \"ts\": " << String((event.start - startTicks) / ticksPerMicrosecond, 3)
+				<< ", \"dur\": " << String((event.end - event.start) / ticksPerMicrosecond, 3);
+
+			if (event.id != -1)
+				stream << ", \"args\": {\"node\": " << String(event.id) << "}";
+
+			stream << "},\n";
+		}
+
+		numberOfEvents += buffer->count;
+		numberOfDropped += buffer->dropped;
+	}
+
+	//The metadata event closes the list without a trailing comma
+	stream << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"OscCalibrator\"}}\n]}\n";
+
+	Logger::writeToLog("OscCalibrator: wrote " + String(numberOfEvents) + " trace events to " + traceFile.getFullPathName()
+		+ (numberOfDropped > 0 ? " (" + String(numberOfDropped) + " dropped)" : String::empty));
+}
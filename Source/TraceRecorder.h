@@ -0,0 +1,90 @@
+/* OscCalibrator - A mapping and routing tool for use with the Open Sound Control protocol.
+   Copyright (C) 2012  Dionysios Marinos - fewbio@googlemail.com
+
+   This program is free software: you can redistribute it and/or modify it under the
+   terms of the GNU General Public License as published by the Free Software Foundation,
+   either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+   without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the GNU General Public License for more details.
+   You should have received a copy of the GNU General Public License along with this program.
+   If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#pragma once
+#include "..\juce\juce_amalgamated.h"
+
+#define TRACE_EVENTS_PER_THREAD 16384 //further events of a thread are dropped until the next recording
+
+//Records a time bounded trace of the processing stages and writes it as Chrome trace event JSON,
+//for about:tracing or Perfetto. Each thread records into its own buffer without any lock; while no
+//trace is being recorded, a TraceScope only reads one flag.
+class TraceRecorder : public Thread
+{
+public:
+	TraceRecorder();
+	~TraceRecorder();
+
+	//Records for this many seconds, or until stop, then writes the file. False if a trace is
+	//already being recorded or the file can't be written.
+	bool start(const File& TraceFile, double Seconds);
+	void stop();
+	bool isBusy() {return isThreadRunning();};
+
+	static bool isRecording() {return recording;};
+	//Adds a complete event to the buffer of the calling thread. Id is shown as an argument unless it's -1.
+	static void addEvent(const char* Name, int64 Start, int64 End, int Id);
+	//Frees the buffer of the calling thread, or once the trace is written if it holds events of it
+	static void releaseThreadBuffer();
+
+	void run();
+
+	juce_UseDebuggingNewOperator
+
+private:
+	static volatile bool recording;
+	static bool collecting; //from start until the trace is written, under the buffers' lock
+
+	File traceFile;
+	double seconds;
+	int64 startTicks;
+
+	void writeTrace();
+	void releaseFinishedBuffers();
+};
+
+//Declared at the top of the run function of a thread that traces, so the buffer of the thread is
+//freed when it ends. Threads come and go with the configuration and with every TCP connection.
+class TraceThread
+{
+public:
+	TraceThread() {};
+	~TraceThread() {TraceRecorder::releaseThreadBuffer();};
+
+private:
+	TraceThread (const TraceThread&);
+	const TraceThread& operator= (const TraceThread&);
+};
+
+//Traces the time from its construction to its destruction as an event named Name, which has to
+//stay valid (a string literal)
+class TraceScope
+{
+public:
+	TraceScope(const char* Name, int Id = -1) : name(Name), id(Id), start(TraceRecorder::isRecording() ? Time::getHighResolutionTicks() : 0) {};
+	~TraceScope()
+	{
+		if (start != 0 && TraceRecorder::isRecording())
+			TraceRecorder::addEvent(name, start, Time::getHighResolutionTicks(), id);
+	};
+
+private:
+	const char* name;
+	int id;
+	int64 start;
+
+	TraceScope (const TraceScope&);
+	const TraceScope& operator= (const TraceScope&);
+};
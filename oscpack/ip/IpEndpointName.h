@@ -54,6 +54,10 @@ public:
     unsigned long address;
     int port;
 
+	// 224.0.0.0 to 239.255.255.255
+	bool IsMulticastAddress() const
+		{ return address != ANY_ADDRESS && (address & 0xF0000000UL) == 0xE0000000UL; }
+
 	enum { ADDRESS_STRING_LENGTH=17 };
 	void AddressAsString( char *s ) const;
 
@@ -39,6 +39,20 @@
 #endif /* INCLUDED_IPENDPOINTNAME_H */
 
 
+// On Linux the SocketReceiveMultiplexer waits with epoll instead of select,
+// and sockets can be attached and detached while Run() is active, from any
+// thread. Define OSC_NO_EPOLL to use select there too.
+#if defined(__linux__) && !defined(OSC_NO_EPOLL)
+#define OSC_MULTIPLEXER_USES_EPOLL
+#endif
+
+// On Linux the datagrams for a port are spread across all sockets bound to it
+// with SetAllowReuse( true ), keeping each sender on the same socket. Elsewhere
+// only one of them receives.
+#if defined(__linux__)
+#define OSC_SOCKET_REUSE_BALANCES
+#endif
+
 class PacketListener;
 class TimerListener;
 
@@ -54,7 +68,10 @@ public:
     SocketReceiveMultiplexer();
     ~SocketReceiveMultiplexer();
 
-	// only call the attach/detach methods _before_ calling Run
+	// only call the attach/detach methods _before_ calling Run, unless
+	// OSC_MULTIPLEXER_USES_EPOLL is defined. in that case detaching a socket
+	// waits until a packet being processed for it has been handled, so the
+	// listener may be deleted afterwards
 
     // only one listener per socket, each socket at most once
     void AttachSocketListener( UdpSocket *socket, PacketListener *listener );
@@ -101,6 +118,34 @@ public:
 	void Send( const char *data, int size );
     void SendTo( const IpEndpointName& remoteEndpoint, const char *data, int size );
 
+	// Send count datagrams to the connected endpoint, with as few system
+	// calls as the platform allows (sendmmsg on Linux)
+	void SendMultiple( const char * const *data, const int *sizes, int count );
+
+
+	// Allow other sockets to bind the same local endpoint (SO_REUSEADDR,
+	// and SO_REUSEPORT where available). Call before Bind()
+	void SetAllowReuse( bool allowReuse );
+
+	// Multicast options. Addresses are in host byte order, interfaces are
+	// given by their address or IpEndpointName::ANY_ADDRESS for the default.
+	// Join and Leave throw std::runtime_error if the membership can't be
+	// changed
+	void SetMulticastTtl( int ttl );
+	void SetMulticastInterface( unsigned long interfaceAddress );
+	void JoinMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress );
+	void LeaveMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress );
+
+	// Receive only the groups joined on this socket, instead of every group
+	// joined on the host for the bound port (IP_MULTICAST_ALL on Linux,
+	// elsewhere that is already the case)
+	void SetReceiveJoinedGroupsOnly( bool joinedOnly );
+
+	// Have the kernel timestamp received datagrams (SO_TIMESTAMPNS where
+	// available). While a listener processes a packet, LastReceiveDelay()
+	// returns the seconds since the datagram arrived, 0 without timestamps
+	void SetReceiveTimestamps( bool enabled );
+	double LastReceiveDelay() const;
 
 	// Bind a local endpoint to receive incoming data. Endpoint
 	// can be 'any' for the system to choose an endpoint
@@ -46,12 +46,33 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <netinet/in.h> // for sockaddr_in
 
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+#include <sys/epoll.h>
+#endif
+
+// receive all packets waiting on a socket with one recvmmsg call. define
+// OSC_NO_RECVMMSG for C libraries without it. on kernels without it (before
+// 2.6.33) the multiplexer falls back to recvfrom at run time
+#if defined(__linux__) && !defined(OSC_NO_RECVMMSG)
+#define OSC_USE_RECVMMSG
+#endif
+
+// the same for sending several datagrams with one sendmmsg call (kernel 3.0)
+#if defined(__linux__) && !defined(OSC_NO_SENDMMSG)
+#define OSC_USE_SENDMMSG
+#endif
+
 #include "ip/PacketListener.h"
 #include "ip/TimerListener.h"
 
 
+// room for the control messages of a received datagram (its timestamp)
+#define RECEIVE_CONTROL_SIZE 64
+
+
 #if defined(__APPLE__) && !defined(_SOCKLEN_T)
 // pre system 10.3 didn have socklen_t
 typedef ssize_t socklen_t;
@@ -75,6 +96,41 @@ static void SockaddrFromIpEndpointName( struct sockaddr_in& sockAddr, const IpEn
 }
 
 
+static unsigned long InterfaceAddress( unsigned long interfaceAddress ) // network byte order
+{
+	return (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? htonl( INADDR_ANY ) : htonl( interfaceAddress );
+}
+
+
+// the seconds between the kernel receive timestamp of a message and now, 0 if
+// it has none (SO_TIMESTAMPNS, or SO_TIMESTAMP where that isn't available)
+static double ReceiveDelay( struct msghdr& message )
+{
+	for( struct cmsghdr *c = CMSG_FIRSTHDR( &message ); c != 0; c = CMSG_NXTHDR( &message, c ) ){
+		if( c->cmsg_level != SOL_SOCKET )
+			continue;
+
+#ifdef SCM_TIMESTAMPNS
+		if( c->cmsg_type == SCM_TIMESTAMPNS ){
+			struct timespec stamp, now;
+			memcpy( &stamp, CMSG_DATA( c ), sizeof(stamp) );
+			clock_gettime( CLOCK_REALTIME, &now );
+			return (double)(now.tv_sec - stamp.tv_sec) + (double)(now.tv_nsec - stamp.tv_nsec) * 1e-9;
+		}
+#else
+		if( c->cmsg_type == SCM_TIMESTAMP ){
+			struct timeval stamp, now;
+			memcpy( &stamp, CMSG_DATA( c ), sizeof(stamp) );
+			gettimeofday( &now, 0 );
+			return (double)(now.tv_sec - stamp.tv_sec) + (double)(now.tv_usec - stamp.tv_usec) * 1e-6;
+		}
+#endif
+	}
+
+	return 0.;
+}
+
+
 static IpEndpointName IpEndpointNameFromSockaddr( const struct sockaddr_in& sockAddr )
 {
 	return IpEndpointName( 
@@ -97,11 +153,13 @@ class UdpSocket::Implementation{
 	struct sockaddr_in sendToAddr_;
 
 public:
+	double lastReceiveDelay_; // set by the multiplexer before a packet is passed on
 
 	Implementation()
 		: isBound_( false )
 		, isConnected_( false )
 		, socket_( -1 )
+		, lastReceiveDelay_( 0. )
 	{
 		if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == -1 ){
             throw std::runtime_error("unable to create udp socket\n");
@@ -179,6 +237,47 @@ public:
         send( socket_, data, size, 0 );
 	}
 
+	void SendMultiple( const char * const *data, const int *sizes, int count )
+	{
+		assert( isConnected_ );
+
+#ifdef OSC_USE_SENDMMSG
+		static bool sendmmsgUnavailable = false;
+
+		const int SEND_BATCH_SIZE = 32;
+		struct mmsghdr messages[ SEND_BATCH_SIZE ];
+		struct iovec vectors[ SEND_BATCH_SIZE ];
+
+		int sent = 0;
+		while( sent < count && !sendmmsgUnavailable ){
+			int batchSize = std::min( count - sent, SEND_BATCH_SIZE );
+
+			memset( messages, 0, sizeof(messages[0]) * batchSize );
+			for( int i=0; i < batchSize; ++i ){
+				vectors[i].iov_base = const_cast<char*>( data[sent + i] );
+				vectors[i].iov_len = sizes[sent + i];
+				messages[i].msg_hdr.msg_iov = &vectors[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int result = sendmmsg( socket_, messages, batchSize, 0 );
+			if( result > 0 )
+				sent += result;
+			else if( result < 0 && errno == ENOSYS )
+				sendmmsgUnavailable = true;
+			else
+				++sent; // the first datagram failed, it is dropped like a failing send()
+		}
+
+		data += sent;
+		sizes += sent;
+		count -= sent;
+#endif
+
+		for( int i=0; i < count; ++i )
+			send( socket_, data[i], sizes[i], 0 );
+	}
+
     void SendTo( const IpEndpointName& remoteEndpoint, const char *data, int size )
 	{
 		sendToAddr_.sin_addr.s_addr = htonl( remoteEndpoint.address );
@@ -187,6 +286,59 @@ public:
         sendto( socket_, data, size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
 	}
 
+	void SetAllowReuse( bool allowReuse )
+	{
+		int reuse = (allowReuse) ? 1 : 0;
+		setsockopt( socket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse) );
+#ifdef SO_REUSEPORT
+		setsockopt( socket_, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse) );
+#endif
+	}
+
+	void SetMulticastTtl( int ttl )
+	{
+		unsigned char value = (unsigned char)ttl;
+		setsockopt( socket_, IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value) );
+	}
+
+	void SetMulticastInterface( unsigned long interfaceAddress )
+	{
+		struct in_addr address;
+		address.s_addr = InterfaceAddress( interfaceAddress );
+		setsockopt( socket_, IPPROTO_IP, IP_MULTICAST_IF, &address, sizeof(address) );
+	}
+
+	void ChangeMembership( int option, unsigned long groupAddress, unsigned long interfaceAddress )
+	{
+		struct ip_mreq request;
+		request.imr_multiaddr.s_addr = htonl( groupAddress );
+		request.imr_interface.s_addr = InterfaceAddress( interfaceAddress );
+
+		if( setsockopt( socket_, IPPROTO_IP, option, &request, sizeof(request) ) < 0 ){
+			throw std::runtime_error("unable to change multicast group membership\n");
+		}
+	}
+
+	void SetReceiveJoinedGroupsOnly( bool joinedOnly )
+	{
+#ifdef IP_MULTICAST_ALL
+		int all = (joinedOnly) ? 0 : 1;
+		setsockopt( socket_, IPPROTO_IP, IP_MULTICAST_ALL, &all, sizeof(all) );
+#else
+		(void) joinedOnly;
+#endif
+	}
+
+	void SetReceiveTimestamps( bool enabled )
+	{
+		int on = (enabled) ? 1 : 0;
+#ifdef SO_TIMESTAMPNS
+		setsockopt( socket_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on) );
+#else
+		setsockopt( socket_, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof(on) );
+#endif
+	}
+
 	void Bind( const IpEndpointName& localEndpoint )
 	{
 		struct sockaddr_in bindSockAddr;
@@ -206,15 +358,27 @@ public:
 		assert( isBound_ );
 
 		struct sockaddr_in fromAddr;
-        socklen_t fromAddrLen = sizeof(fromAddr);
-             	 
-        int result = recvfrom(socket_, data, size, 0,
-                    (struct sockaddr *) &fromAddr, (socklen_t*)&fromAddrLen);
+		struct iovec vector;
+		char control[ RECEIVE_CONTROL_SIZE ];
+		struct msghdr message;
+
+		vector.iov_base = data;
+		vector.iov_len = size;
+		memset( &message, 0, sizeof(message) );
+		message.msg_name = &fromAddr;
+		message.msg_namelen = sizeof(fromAddr);
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+        int result = recvmsg(socket_, &message, 0);
 		if( result < 0 )
 			return 0;
 
 		remoteEndpoint.address = ntohl(fromAddr.sin_addr.s_addr);
 		remoteEndpoint.port = ntohs(fromAddr.sin_port);
+		lastReceiveDelay_ = ReceiveDelay( message );
 
 		return result;
 	}
@@ -247,11 +411,56 @@ void UdpSocket::Send( const char *data, int size )
 	impl_->Send( data, size );
 }
 
+void UdpSocket::SendMultiple( const char * const *data, const int *sizes, int count )
+{
+	impl_->SendMultiple( data, sizes, count );
+}
+
 void UdpSocket::SendTo( const IpEndpointName& remoteEndpoint, const char *data, int size )
 {
 	impl_->SendTo( remoteEndpoint, data, size );
 }
 
+void UdpSocket::SetAllowReuse( bool allowReuse )
+{
+	impl_->SetAllowReuse( allowReuse );
+}
+
+void UdpSocket::SetMulticastTtl( int ttl )
+{
+	impl_->SetMulticastTtl( ttl );
+}
+
+void UdpSocket::SetMulticastInterface( unsigned long interfaceAddress )
+{
+	impl_->SetMulticastInterface( interfaceAddress );
+}
+
+void UdpSocket::JoinMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress )
+{
+	impl_->ChangeMembership( IP_ADD_MEMBERSHIP, groupAddress, interfaceAddress );
+}
+
+void UdpSocket::LeaveMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress )
+{
+	impl_->ChangeMembership( IP_DROP_MEMBERSHIP, groupAddress, interfaceAddress );
+}
+
+void UdpSocket::SetReceiveJoinedGroupsOnly( bool joinedOnly )
+{
+	impl_->SetReceiveJoinedGroupsOnly( joinedOnly );
+}
+
+void UdpSocket::SetReceiveTimestamps( bool enabled )
+{
+	impl_->SetReceiveTimestamps( enabled );
+}
+
+double UdpSocket::LastReceiveDelay() const
+{
+	return impl_->lastReceiveDelay_;
+}
+
 void UdpSocket::Bind( const IpEndpointName& localEndpoint )
 {
 	impl_->Bind( localEndpoint );
@@ -303,6 +512,71 @@ class SocketReceiveMultiplexer::Implementation{
 	volatile bool break_;
 	int breakPipe_[2]; // [0] is the reader descriptor and [1] the writer
 
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+	int epollFd_;
+	pthread_mutex_t socketListenersMutex_; // held while socketListeners_ changes and while a packet is processed
+
+	void AddToEpoll( int fd )
+	{
+		struct epoll_event event;
+		memset( &event, 0, sizeof(event) );
+		event.events = EPOLLIN;
+		event.data.fd = fd;
+		if( epoll_ctl( epollFd_, EPOLL_CTL_ADD, fd, &event ) != 0 )
+			throw std::runtime_error( "adding a socket to epoll failed\n" );
+	}
+
+	void RunEpoll( std::vector< std::pair< double, AttachedTimerListener > >& timerQueue_, char *data, int dataSize );
+#endif
+
+#ifdef OSC_USE_RECVMMSG
+	// a ring of preallocated buffers, filled by one recvmmsg call per wakeup
+	enum { RECEIVE_BATCH_SIZE = 32, RECEIVE_BUFFER_SIZE = 4098 };
+	char *batchData_;
+	struct mmsghdr batchMessages_[ RECEIVE_BATCH_SIZE ];
+	struct iovec batchVectors_[ RECEIVE_BATCH_SIZE ];
+	struct sockaddr_in batchAddresses_[ RECEIVE_BATCH_SIZE ];
+	char batchControl_[ RECEIVE_BATCH_SIZE ][ RECEIVE_CONTROL_SIZE ];
+	bool recvmmsgUnavailable_;
+#endif
+
+	// receives what is waiting on a readable socket and hands it to the listener:
+	// a batch of packets where recvmmsg is available, a single packet otherwise
+	void ReceivePackets( PacketListener *listener, UdpSocket *socket, char *data, int dataSize )
+	{
+#ifdef OSC_USE_RECVMMSG
+		if( !recvmmsgUnavailable_ ){
+			for( int i=0; i < RECEIVE_BATCH_SIZE; ++i ){
+				batchMessages_[i].msg_hdr.msg_namelen = sizeof(batchAddresses_[i]);
+				batchMessages_[i].msg_hdr.msg_controllen = RECEIVE_CONTROL_SIZE;
+			}
+
+			int count = recvmmsg( socket->impl_->Socket(), batchMessages_, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, 0 );
+			if( count >= 0 ){
+				for( int i=0; i < count && !break_; ++i ){
+					if( batchMessages_[i].msg_len > 0 ){
+						IpEndpointName remoteEndpoint(
+								ntohl( batchAddresses_[i].sin_addr.s_addr ), ntohs( batchAddresses_[i].sin_port ) );
+						socket->impl_->lastReceiveDelay_ = ReceiveDelay( batchMessages_[i].msg_hdr );
+						listener->ProcessPacket( batchData_ + i * RECEIVE_BUFFER_SIZE, (int)batchMessages_[i].msg_len, remoteEndpoint );
+					}
+				}
+				return;
+			}
+
+			if( errno != ENOSYS )
+				return; // nothing was waiting after all
+
+			recvmmsgUnavailable_ = true;
+		}
+#endif
+
+		IpEndpointName remoteEndpoint;
+		int size = socket->ReceiveFrom( remoteEndpoint, data, dataSize );
+		if( size > 0 )
+			listener->ProcessPacket( data, size, remoteEndpoint );
+	}
+
 	double GetCurrentTimeMs() const
 	{
 		struct timeval t;
@@ -317,10 +591,44 @@ public:
 	{
 		if( pipe(breakPipe_) != 0 )
 			throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
+
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		if( (epollFd_ = epoll_create( 16 )) == -1 )
+			throw std::runtime_error( "creation of epoll instance failed\n" );
+		AddToEpoll( breakPipe_[0] );
+
+		// recursive, so that listeners can detach sockets from within ProcessPacket
+		pthread_mutexattr_t attributes;
+		pthread_mutexattr_init( &attributes );
+		pthread_mutexattr_settype( &attributes, PTHREAD_MUTEX_RECURSIVE );
+		pthread_mutex_init( &socketListenersMutex_, &attributes );
+		pthread_mutexattr_destroy( &attributes );
+#endif
+
+#ifdef OSC_USE_RECVMMSG
+		batchData_ = new char[ RECEIVE_BATCH_SIZE * RECEIVE_BUFFER_SIZE ];
+		memset( batchMessages_, 0, sizeof(batchMessages_) );
+		for( int i=0; i < RECEIVE_BATCH_SIZE; ++i ){
+			batchVectors_[i].iov_base = batchData_ + i * RECEIVE_BUFFER_SIZE;
+			batchVectors_[i].iov_len = RECEIVE_BUFFER_SIZE;
+			batchMessages_[i].msg_hdr.msg_iov = &batchVectors_[i];
+			batchMessages_[i].msg_hdr.msg_iovlen = 1;
+			batchMessages_[i].msg_hdr.msg_name = &batchAddresses_[i];
+			batchMessages_[i].msg_hdr.msg_control = batchControl_[i];
+		}
+		recvmmsgUnavailable_ = false;
+#endif
 	}
 
     ~Implementation()
 	{
+#ifdef OSC_USE_RECVMMSG
+		delete [] batchData_;
+#endif
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		close( epollFd_ );
+		pthread_mutex_destroy( &socketListenersMutex_ );
+#endif
 		close( breakPipe_[0] );
 		close( breakPipe_[1] );
 	}
@@ -329,16 +637,43 @@ public:
 	{
 		assert( std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) ) == socketListeners_.end() );
 		// we don't check that the same socket has been added multiple times, even though this is an error
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		// the socket is only listed once epoll accepted it, and the mutex is released if either fails
+		pthread_mutex_lock( &socketListenersMutex_ );
+		bool added = false;
+		try{
+			AddToEpoll( socket->impl_->Socket() );
+			added = true;
+			socketListeners_.push_back( std::make_pair( listener, socket ) );
+		}catch(...){
+			if( added ){
+				struct epoll_event event; // ignored, but required by kernels before 2.6.9
+				epoll_ctl( epollFd_, EPOLL_CTL_DEL, socket->impl_->Socket(), &event );
+			}
+			pthread_mutex_unlock( &socketListenersMutex_ );
+			throw;
+		}
+		pthread_mutex_unlock( &socketListenersMutex_ );
+#else
 		socketListeners_.push_back( std::make_pair( listener, socket ) );
+#endif
 	}
 
     void DetachSocketListener( UdpSocket *socket, PacketListener *listener )
 	{
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		pthread_mutex_lock( &socketListenersMutex_ );
+#endif
 		std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = 
 				std::find( socketListeners_.begin(), socketListeners_.end(), std::make_pair(listener, socket) );
 		assert( i != socketListeners_.end() );
 
 		socketListeners_.erase( i );
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		struct epoll_event event; // ignored, but required by kernels before 2.6.9
+		epoll_ctl( epollFd_, EPOLL_CTL_DEL, socket->impl_->Socket(), &event );
+		pthread_mutex_unlock( &socketListenersMutex_ );
+#endif
 	}
 
     void AttachPeriodicTimerListener( int periodMilliseconds, TimerListener *listener )
@@ -369,6 +704,32 @@ public:
 	{
 		break_ = false;
 
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+		{
+			// configure the timer queue
+			double currentTimeMs = GetCurrentTimeMs();
+
+			std::vector< std::pair< double, AttachedTimerListener > > timerQueue_;
+			for( std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
+					i != timerListeners_.end(); ++i )
+				timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
+			std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
+
+			const int MAX_BUFFER_SIZE = 4098;
+			char *data = new char[ MAX_BUFFER_SIZE ];
+
+			try{
+				RunEpoll( timerQueue_, data, MAX_BUFFER_SIZE );
+			}catch( ... ){
+				delete [] data;
+				throw;
+			}
+
+			delete [] data;
+			return;
+		}
+#endif
+
 		// configure the master fd_set for select()
 
 		fd_set masterfds, tempfds;
@@ -402,7 +763,6 @@ public:
 
 		const int MAX_BUFFER_SIZE = 4098;
 		char *data = new char[ MAX_BUFFER_SIZE ];
-		IpEndpointName remoteEndpoint;
 
 		struct timeval timeout;
 
@@ -439,12 +799,9 @@ public:
 
 				if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
 
-					int size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-					if( size > 0 ){
-						i->first->ProcessPacket( data, size, remoteEndpoint );
-						if( break_ )
-							break;
-					}
+					ReceivePackets( i->first, i->second, data, MAX_BUFFER_SIZE );
+					if( break_ )
+						break;
 				}
 			}
 
@@ -483,6 +840,83 @@ public:
 };
 
 
+#ifdef OSC_MULTIPLEXER_USES_EPOLL
+
+void SocketReceiveMultiplexer::Implementation::RunEpoll(
+		std::vector< std::pair< double, AttachedTimerListener > >& timerQueue_, char *data, int dataSize )
+{
+	const int MAX_EVENTS = 64;
+	struct epoll_event events[ MAX_EVENTS ];
+
+	while( !break_ ){
+		int timeoutMs = -1;
+		if( !timerQueue_.empty() ){
+			double ms = timerQueue_.front().first - GetCurrentTimeMs();
+			timeoutMs = (ms < 0) ? 0 : (int)ceil( ms );
+		}
+
+		int eventCount = epoll_wait( epollFd_, events, MAX_EVENTS, timeoutMs );
+		if( eventCount < 0 ){
+			if( errno != EINTR )
+				throw std::runtime_error("epoll_wait failed\n");
+			eventCount = 0;
+		}
+
+		for( int e=0; e < eventCount && !break_; ++e ){
+			int fd = events[e].data.fd;
+
+			if( fd == breakPipe_[0] ){
+				// clear pending data from the asynchronous break pipe
+				char c;
+				read( breakPipe_[0], &c, 1 );
+				continue;
+			}
+
+			// the socket may have been detached since epoll_wait returned,
+			// so it is looked up by its descriptor under the lock
+			pthread_mutex_lock( &socketListenersMutex_ );
+
+			for( std::vector< std::pair< PacketListener*, UdpSocket* > >::iterator i = socketListeners_.begin();
+					i != socketListeners_.end(); ++i ){
+
+				if( i->second->impl_->Socket() == fd ){
+					try{
+						ReceivePackets( i->first, i->second, data, dataSize );
+					}catch( ... ){
+						pthread_mutex_unlock( &socketListenersMutex_ );
+						throw;
+					}
+					break;
+				}
+			}
+
+			pthread_mutex_unlock( &socketListenersMutex_ );
+		}
+
+		if( break_ )
+			break;
+
+		// execute any expired timers
+		double currentTimeMs = GetCurrentTimeMs();
+		bool resort = false;
+		for( std::vector< std::pair< double, AttachedTimerListener > >::iterator i = timerQueue_.begin();
+				i != timerQueue_.end() && i->first <= currentTimeMs; ++i ){
+
+			i->second.listener->TimerExpired();
+			if( break_ )
+				break;
+
+			i->first += i->second.periodMs;
+			resort = true;
+		}
+		if( resort )
+			std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
+	}
+}
+
+#endif /* OSC_MULTIPLEXER_USES_EPOLL */
+
+
 
 SocketReceiveMultiplexer::SocketReceiveMultiplexer()
 {
@@ -30,6 +30,7 @@
 #include "../UdpSocket.h"
 
 #include <winsock2.h>   // this must come first to prevent errors with MSVC7
+#include <ws2tcpip.h>   // for ip_mreq
 #include <windows.h>
 #include <mmsystem.h>   // for timeGetTime()
 
@@ -64,6 +65,12 @@ static void SockaddrFromIpEndpointName( struct sockaddr_in& sockAddr, const IpEn
 }
 
 
+static unsigned long InterfaceAddress( unsigned long interfaceAddress ) // network byte order
+{
+	return (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? htonl( INADDR_ANY ) : htonl( interfaceAddress );
+}
+
+
 static IpEndpointName IpEndpointNameFromSockaddr( const struct sockaddr_in& sockAddr )
 {
 	return IpEndpointName( 
@@ -169,6 +176,14 @@ public:
         send( socket_, data, size, 0 );
 	}
 
+	void SendMultiple( const char * const *data, const int *sizes, int count )
+	{
+		assert( isConnected_ );
+
+		for( int i=0; i < count; ++i )
+			send( socket_, data[i], sizes[i], 0 );
+	}
+
     void SendTo( const IpEndpointName& remoteEndpoint, const char *data, int size )
 	{
 		sendToAddr_.sin_addr.s_addr = htonl( remoteEndpoint.address );
@@ -177,6 +192,42 @@ public:
         sendto( socket_, data, size, 0, (sockaddr*)&sendToAddr_, sizeof(sendToAddr_) );
 	}
 
+	void SetAllowReuse( bool allowReuse )
+	{
+		BOOL reuse = (allowReuse) ? TRUE : FALSE;
+		setsockopt( socket_, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse) );
+	}
+
+	void SetMulticastTtl( int ttl )
+	{
+		DWORD value = (DWORD)ttl;
+		setsockopt( socket_, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&value, sizeof(value) );
+	}
+
+	void SetMulticastInterface( unsigned long interfaceAddress )
+	{
+		struct in_addr address;
+		address.s_addr = InterfaceAddress( interfaceAddress );
+		setsockopt( socket_, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&address, sizeof(address) );
+	}
+
+	void ChangeMembership( int option, unsigned long groupAddress, unsigned long interfaceAddress )
+	{
+		struct ip_mreq request;
+		request.imr_multiaddr.s_addr = htonl( groupAddress );
+		request.imr_interface.s_addr = InterfaceAddress( interfaceAddress );
+
+		if( setsockopt( socket_, IPPROTO_IP, option, (const char*)&request, sizeof(request) ) < 0 ){
+			throw std::runtime_error("unable to change multicast group membership\n");
+		}
+	}
+
+	void SetReceiveJoinedGroupsOnly( bool joinedOnly )
+	{
+		// winsock only delivers the groups joined on the socket
+		(void) joinedOnly;
+	}
+
 	void Bind( const IpEndpointName& localEndpoint )
 	{
 		struct sockaddr_in bindSockAddr;
@@ -238,11 +289,57 @@ void UdpSocket::Send( const char *data, int size )
 	impl_->Send( data, size );
 }
 
+void UdpSocket::SendMultiple( const char * const *data, const int *sizes, int count )
+{
+	impl_->SendMultiple( data, sizes, count );
+}
+
 void UdpSocket::SendTo( const IpEndpointName& remoteEndpoint, const char *data, int size )
 {
 	impl_->SendTo( remoteEndpoint, data, size );
 }
 
+void UdpSocket::SetAllowReuse( bool allowReuse )
+{
+	impl_->SetAllowReuse( allowReuse );
+}
+
+void UdpSocket::SetMulticastTtl( int ttl )
+{
+	impl_->SetMulticastTtl( ttl );
+}
+
+void UdpSocket::SetMulticastInterface( unsigned long interfaceAddress )
+{
+	impl_->SetMulticastInterface( interfaceAddress );
+}
+
+void UdpSocket::JoinMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress )
+{
+	impl_->ChangeMembership( IP_ADD_MEMBERSHIP, groupAddress, interfaceAddress );
+}
+
+void UdpSocket::LeaveMulticastGroup( unsigned long groupAddress, unsigned long interfaceAddress )
+{
+	impl_->ChangeMembership( IP_DROP_MEMBERSHIP, groupAddress, interfaceAddress );
+}
+
+void UdpSocket::SetReceiveJoinedGroupsOnly( bool joinedOnly )
+{
+	impl_->SetReceiveJoinedGroupsOnly( joinedOnly );
+}
+
+void UdpSocket::SetReceiveTimestamps( bool enabled )
+{
+	// winsock has no receive timestamps for UDP
+	(void) enabled;
+}
+
+double UdpSocket::LastReceiveDelay() const
+{
+	return 0.;
+}
+
 void UdpSocket::Bind( const IpEndpointName& localEndpoint )
 {
 	impl_->Bind( localEndpoint );
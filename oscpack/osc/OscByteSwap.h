@@ -0,0 +1,78 @@
+/*
+	oscpack -- Open Sound Control packet manipulation library
+	http://www.audiomulch.com/~rossb/oscpack
+
+	Copyright (c) 2004-2005 Ross Bencina <rossb@audiomulch.com>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef INCLUDED_OSCBYTESWAP_H
+#define INCLUDED_OSCBYTESWAP_H
+
+#include <string.h>
+
+#include "OscHostEndianness.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OSC_BYTESWAP_SSE2
+#endif
+
+
+namespace osc{
+
+// Copies count 32 bit values (int32 or float) between host byte order and
+// the big endian order of OSC arguments. The conversion is symmetric, so the
+// same function is used for encoding and decoding. source and destination
+// need not be aligned but must not overlap.
+inline void CopyBigEndian32( char *destination, const char *source, unsigned long count )
+{
+#ifdef OSC_HOST_LITTLE_ENDIAN
+    unsigned long i = 0;
+
+#ifdef OSC_BYTESWAP_SSE2
+    // SSE2 has no byte shuffle: swap the bytes of each 16 bit half, then the halves
+    for( ; i + 4 <= count; i += 4 ){
+        __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>(source + i*4) );
+        v = _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+        v = _mm_shufflelo_epi16( v, _MM_SHUFFLE(2,3,0,1) );
+        v = _mm_shufflehi_epi16( v, _MM_SHUFFLE(2,3,0,1) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>(destination + i*4), v );
+    }
+#endif
+
+    for( ; i < count; ++i ){
+        destination[i*4 + 0] = source[i*4 + 3];
+        destination[i*4 + 1] = source[i*4 + 2];
+        destination[i*4 + 2] = source[i*4 + 1];
+        destination[i*4 + 3] = source[i*4 + 0];
+    }
+#else
+    memcpy( destination, source, count*4 );
+#endif
+}
+
+} // namespace osc
+
+#endif /* INCLUDED_OSCBYTESWAP_H */
@@ -38,6 +38,7 @@
 #endif
 
 #include "OscHostEndianness.h"
+#include "OscByteSwap.h"
 
 
 namespace osc{
@@ -229,11 +230,11 @@ void OutboundPacketStream::CheckForAvailableMessageSpace( const char *addressPat
 }
 
 
-void OutboundPacketStream::CheckForAvailableArgumentSpace( long argumentLength )
+void OutboundPacketStream::CheckForAvailableArgumentSpace( long argumentLength, long typeTagCount )
 {
-    // plus three for extra type tag, comma and null terminator
+    // plus two for comma and null terminator
      unsigned long required = (argumentCurrent_ - data_) + argumentLength
-            + RoundUp4( (end_ - typeTagsCurrent_) + 3 );
+            + RoundUp4( (end_ - typeTagsCurrent_) + typeTagCount + 2 );
 
     if( required > Capacity() )
         throw OutOfBufferMemoryException();
@@ -634,6 +635,34 @@ OutboundPacketStream& OutboundPacketStream::operator<<( const Blob& rhs )
     return *this;
 }
 
+void OutboundPacketStream::WriteArray32( char typeTag, const char *values, unsigned long count )
+{
+    CheckForAvailableArgumentSpace( count * 4, count );
+
+    typeTagsCurrent_ -= count;
+    memset( typeTagsCurrent_, typeTag, count );
+
+    CopyBigEndian32( argumentCurrent_, values, count );
+    argumentCurrent_ += count * 4;
+}
+
+
+OutboundPacketStream& OutboundPacketStream::operator<<( const FloatArray& rhs )
+{
+    WriteArray32( FLOAT_TYPE_TAG, reinterpret_cast<const char*>(rhs.values), rhs.count );
+
+    return *this;
+}
+
+
+OutboundPacketStream& OutboundPacketStream::operator<<( const Int32Array& rhs )
+{
+    WriteArray32( INT32_TYPE_TAG, reinterpret_cast<const char*>(rhs.values), rhs.count );
+
+    return *this;
+}
+
+
 } // namespace osc
 
 
@@ -111,6 +111,8 @@ public:
     OutboundPacketStream& operator<<( const char* rhs );
     OutboundPacketStream& operator<<( const Symbol& rhs );
     OutboundPacketStream& operator<<( const Blob& rhs );
+    OutboundPacketStream& operator<<( const FloatArray& rhs );
+    OutboundPacketStream& operator<<( const Int32Array& rhs );
 
 private:
 
@@ -120,7 +122,8 @@ private:
     bool ElementSizeSlotRequired() const;
     void CheckForAvailableBundleSpace();
     void CheckForAvailableMessageSpace( const char *addressPattern );
-    void CheckForAvailableArgumentSpace( long argumentLength );
+    void CheckForAvailableArgumentSpace( long argumentLength, long typeTagCount=1 );
+    void WriteArray32( char typeTag, const char *values, unsigned long count );
 
     char *data_;
     char *end_;
@@ -32,6 +32,7 @@
 #include <cassert>
 
 #include "OscHostEndianness.h"
+#include "OscByteSwap.h"
 
 
 namespace osc{
@@ -524,6 +525,70 @@ ReceivedMessage::ReceivedMessage( const ReceivedBundleElement& bundleElement )
 }
 
 
+unsigned long ReceivedMessage::ReadArray32( char typeTag, char *values, unsigned long maxCount ) const
+{
+    unsigned long count = 0;
+    while( count < maxCount && typeTagsBegin_ + count != typeTagsEnd_
+            && typeTagsBegin_[count] == typeTag )
+        ++count;
+
+    CopyBigEndian32( values, arguments_, count );
+
+    return count;
+}
+
+
+unsigned long ReceivedMessage::ReadFloatArray( float *values, unsigned long maxCount ) const
+{
+    return ReadArray32( FLOAT_TYPE_TAG, reinterpret_cast<char*>(values), maxCount );
+}
+
+
+unsigned long ReceivedMessage::ReadInt32Array( int32 *values, unsigned long maxCount ) const
+{
+    return ReadArray32( INT32_TYPE_TAG, reinterpret_cast<char*>(values), maxCount );
+}
+
+
+unsigned long ReceivedMessage::ReadFloatArguments( float *values, unsigned long maxCount ) const
+{
+    // the common case, all floats, is copied in one block
+    unsigned long count = ReadFloatArray( values, maxCount );
+    if( count == maxCount || typeTagsBegin_ + count == typeTagsEnd_ )
+        return count;
+
+    ReceivedMessageArgumentIterator i = ArgumentsBegin();
+    for( unsigned long skipped = 0; skipped < count; ++skipped )
+        ++i;
+
+    for( ; i != ArgumentsEnd() && count < maxCount; ++i, ++count ){
+
+        switch( i->TypeTag() ){
+            case FLOAT_TYPE_TAG:
+                values[count] = i->AsFloatUnchecked();
+                break;
+            case INT32_TYPE_TAG:
+                values[count] = static_cast<float>( i->AsInt32Unchecked() );
+                break;
+            case INT64_TYPE_TAG:
+                values[count] = static_cast<float>( i->AsInt64Unchecked() );
+                break;
+            case DOUBLE_TYPE_TAG:
+                values[count] = static_cast<float>( i->AsDoubleUnchecked() );
+                break;
+            case TRUE_TYPE_TAG:
+                values[count] = 1.f;
+                break;
+            default:
+                values[count] = 0.f;
+                break;
+        }
+    }
+
+    return count;
+}
+
+
 bool ReceivedMessage::AddressPatternIsUInt32() const
 {
 	return (addressPattern_[0] == '\0');
@@ -411,6 +411,7 @@ public:
 
 class ReceivedMessage{
     void Init( const char *bundle, unsigned long size );
+    unsigned long ReadArray32( char typeTag, char *values, unsigned long maxCount ) const;
 public:
     explicit ReceivedMessage( const ReceivedPacket& packet );
     explicit ReceivedMessage( const ReceivedBundleElement& bundleElement );
@@ -443,6 +444,17 @@ public:
         return ReceivedMessageArgumentStream( ArgumentsBegin(), ArgumentsEnd() );
     }
 
+    // Converts up to maxCount numeric arguments (int32, int64, float, double,
+    // true/false) to floats in values, without allocating. Other arguments
+    // read as 0. Returns the number of values written.
+    unsigned long ReadFloatArguments( float *values, unsigned long maxCount ) const;
+
+    // Copy the leading run of up to maxCount float (or int32) arguments into
+    // values in one block. Returns the length of the run, which ends at the
+    // first argument of another type.
+    unsigned long ReadFloatArray( float *values, unsigned long maxCount ) const;
+    unsigned long ReadInt32Array( int32 *values, unsigned long maxCount ) const;
+
 private:
 	const char *addressPattern_;
 	const char *typeTagsBegin_;
@@ -459,6 +471,10 @@ public:
 
     uint64 TimeTag() const;
 
+    // the whole bundle, starting with "#bundle", e.g. to keep a copy of it
+    const char *Contents() const { return timeTag_ - 8; }
+    unsigned long Size() const { return (unsigned long)(end_ - Contents()); }
+
     unsigned long ElementCount() const { return elementCount_; }
 
     typedef ReceivedBundleElementIterator const_iterator;
@@ -172,6 +172,25 @@ struct Blob{
     unsigned long size;
 };
 
+
+// A run of float or int32 arguments, written with a single capacity check
+struct FloatArray{
+    FloatArray() {}
+    explicit FloatArray( const float* values_, unsigned long count_ )
+            : values( values_ ), count( count_ ) {}
+    const float* values;
+    unsigned long count;
+};
+
+
+struct Int32Array{
+    Int32Array() {}
+    explicit Int32Array( const int32* values_, unsigned long count_ )
+            : values( values_ ), count( count_ ) {}
+    const int32* values;
+    unsigned long count;
+};
+
 } // namespace osc
 
 
@@ -31,12 +31,36 @@
 
 #include <iostream>
 #include <iomanip>
+#include <cstdlib>
+#include <new>
 
 #include "osc/OscReceivedElements.h"
 #include "osc/OscPrintReceivedElements.h"
 #include "osc/OscOutboundPacketStream.h"
 
 
+// counts heap allocations, for the tests of allocation free code paths
+static unsigned long allocationCount_ = 0;
+
+#ifndef NO_OSC_TEST_MAIN
+
+void* operator new( std::size_t size ) throw( std::bad_alloc )
+{
+    ++allocationCount_;
+    void *p = std::malloc( size ? size : 1 );
+    if( !p )
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete( void *p ) throw()
+{
+    std::free( p );
+}
+
+#endif
+
+
 namespace osc{
 
 static int passCount_=0, failCount_=0;
@@ -384,12 +408,149 @@ void test3()
     }
 }
 
+// decoding received messages into preallocated values must not allocate
+
+void test4()
+{
+    char buffer[256];
+    OutboundPacketStream ps( buffer, 256 );
+    ps << BeginBundle()
+        << BeginMessage( "/values" ) << 1.5f << (int32)2 << (double)3.0 << true << "x" << EndMessage
+        << BeginMessage( "/values" ) << -1.f << false << EndMessage
+        << EndBundle;
+    assertEqual( ps.IsReady(), true );
+
+    float values[8];
+    unsigned long counts[2] = { 0, 0 };
+
+    unsigned long allocationsBefore = allocationCount_;
+    for( int n=0; n < 1000; ++n ){
+        ReceivedBundle b( ReceivedPacket(ps.Data(), ps.Size()) );
+
+        int element = 0;
+        for( ReceivedBundle::const_iterator i = b.ElementsBegin(); i != b.ElementsEnd(); ++i, ++element ){
+            ReceivedMessage m( *i );
+            counts[element] = m.ReadFloatArguments( values, 8 );
+        }
+    }
+    assertEqual( allocationCount_, allocationsBefore );
+
+    assertEqual( counts[0], (unsigned long)5 );
+    assertEqual( counts[1], (unsigned long)2 );
+    assertEqual( values[0], -1.f );
+    assertEqual( values[1], 0.f );
+
+    ReceivedBundle b( ReceivedPacket(ps.Data(), ps.Size()) );
+    ReceivedMessage m( *b.ElementsBegin() );
+    assertEqual( m.ReadFloatArguments( values, 8 ), (unsigned long)5 );
+    assertEqual( values[0], 1.5f );
+    assertEqual( values[1], 2.f );
+    assertEqual( values[2], 3.f );
+    assertEqual( values[3], 1.f );
+    assertEqual( values[4], 0.f );
+
+    // stops at maxCount
+    assertEqual( m.ReadFloatArguments( values, 2 ), (unsigned long)2 );
+}
+
+// bulk array arguments must encode and decode like single arguments
+
+void test5()
+{
+    float floats[37];
+    int32 ints[37];
+    for( int i=0; i < 37; ++i ){
+        floats[i] = i * -1.25f;
+        ints[i] = i * 1000003 - 7;
+    }
+
+    char buffer[1024];
+    OutboundPacketStream ps( buffer, 1024 );
+    ps << BeginMessage( "/arrays" ) << FloatArray( floats, 37 ) << Int32Array( ints, 37 ) << EndMessage;
+
+    char expectedBuffer[1024];
+    OutboundPacketStream expected( expectedBuffer, 1024 );
+    expected << BeginMessage( "/arrays" );
+    for( int i=0; i < 37; ++i )
+        expected << floats[i];
+    for( int i=0; i < 37; ++i )
+        expected << ints[i];
+    expected << EndMessage;
+
+    assertEqual( ps.Size(), expected.Size() );
+    assertEqual( (memcmp( ps.Data(), expected.Data(), ps.Size() ) == 0), true );
+
+    ReceivedMessage m( ReceivedPacket(ps.Data(), ps.Size()) );
+
+    float floatsRead[64];
+    assertEqual( m.ReadFloatArray( floatsRead, 64 ), (unsigned long)37 );
+    assertEqual( (memcmp( floatsRead, floats, sizeof(floats) ) == 0), true );
+    assertEqual( m.ReadFloatArray( floatsRead, 5 ), (unsigned long)5 );
+
+    // the int32 run follows the floats
+    assertEqual( m.ReadFloatArguments( floatsRead, 64 ), (unsigned long)64 );
+    assertEqual( floatsRead[36], floats[36] );
+    assertEqual( floatsRead[37], (float)ints[0] );
+    assertEqual( floatsRead[63], (float)ints[26] );
+
+    int32 intsRead[64];
+    assertEqual( m.ReadInt32Array( intsRead, 64 ), (unsigned long)0 );
+
+    // an array that doesn't fit must not be written
+    char smallBuffer[64];
+    OutboundPacketStream small( smallBuffer, 64 );
+    small << BeginMessage( "/arrays" );
+    bool outOfMemory = false;
+    try{
+        small << FloatArray( floats, 37 );
+    }catch( OutOfBufferMemoryException& ){
+        outOfMemory = true;
+    }
+    assertEqual( outOfMemory, true );
+    assertEqual( (small << EndMessage).Size(), (unsigned int)12 );
+}
+
+// a bundle must expose its whole encoding, including nested bundles
+
+void test6()
+{
+    char buffer[256];
+    OutboundPacketStream ps( buffer, 256 );
+    ps << BeginBundle( 0x0123456789ABCDEFULL )
+        << BeginMessage( "/a" ) << 1.f << EndMessage
+        << BeginBundle( 1 )
+            << BeginMessage( "/b" ) << 2.f << EndMessage
+        << EndBundle
+        << EndBundle;
+
+    ReceivedBundle b( ReceivedPacket(ps.Data(), ps.Size()) );
+    assertEqual( b.Contents(), ps.Data() );
+    assertEqual( b.Size(), (unsigned long)ps.Size() );
+
+    // a copy reads back the same
+    char copy[256];
+    memcpy( copy, b.Contents(), b.Size() );
+    ReceivedBundle c( ReceivedPacket(copy, b.Size()) );
+    assertEqual( c.TimeTag(), (uint64)0x0123456789ABCDEFULL );
+    assertEqual( c.ElementCount(), (unsigned long)2 );
+
+    ReceivedBundle::const_iterator i = b.ElementsBegin();
+    ++i;
+    ReceivedBundle nested( *i );
+    assertEqual( nested.Contents(), i->Contents() );
+    assertEqual( nested.Size(), (unsigned long)i->Size() );
+    assertEqual( nested.TimeTag(), (uint64)1 );
+}
+
 
 void RunUnitTests()
 {
     test1();
     test2();
     test3();
+    test4();
+    test5();
+    test6();
     PrintTestSummary();
 }
 